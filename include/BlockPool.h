@@ -0,0 +1,109 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 14:02:18 PDT 2026
+// Last Modified: Mon Oct 19 21:10:04 PDT 2026
+// Filename:      BlockPool.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Block allocator for the holes, tears and shifts of a
+//                roll.  Items are allocated in contiguous blocks owned
+//                by the pool rather than one at a time on the heap, and
+//                are all released together when the pool is destroyed.
+//                The item class must have a clear() function.
+//
+
+#ifndef _BLOCKPOOL_H
+#define _BLOCKPOOL_H
+
+#include <vector>
+
+namespace rip  {
+
+template <class TYPE>
+class BlockPool {
+	public:
+		               BlockPool  (unsigned long blocksize = 4096);
+		              ~BlockPool  ();
+
+		TYPE*          allocate   (void);
+		void           release    (void);
+		unsigned long  size       (void) { return m_used; }
+
+	private:
+		std::vector<TYPE*> m_blocks;    // storage blocks of m_blocksize items
+		unsigned long      m_blocksize; // number of items in each block
+		unsigned long      m_used;      // number of items handed out
+};
+
+
+
+//////////////////////////////
+//
+// BlockPool::BlockPool --
+//
+
+template <class TYPE>
+BlockPool<TYPE>::BlockPool(unsigned long blocksize) {
+	m_blocksize = blocksize > 0 ? blocksize : 1;
+	m_used      = 0;
+}
+
+
+
+//////////////////////////////
+//
+// BlockPool::~BlockPool --
+//
+
+template <class TYPE>
+BlockPool<TYPE>::~BlockPool() {
+	release();
+}
+
+
+
+//////////////////////////////
+//
+// BlockPool::allocate -- Return the next unused item in the pool, adding
+//    a new block when the current ones are full.  The pointer remains
+//    valid until the pool is released.
+//
+
+template <class TYPE>
+TYPE* BlockPool<TYPE>::allocate(void) {
+	unsigned long block = m_used / m_blocksize;
+	unsigned long index = m_used % m_blocksize;
+	if (block >= m_blocks.size()) {
+		m_blocks.push_back(new TYPE[m_blocksize]);
+	}
+	m_used++;
+	TYPE* item = &m_blocks[block][index];
+	item->clear();
+	return item;
+}
+
+
+
+//////////////////////////////
+//
+// BlockPool::release -- Free all storage blocks.  All previously
+//    allocated pointers become invalid.
+//
+
+template <class TYPE>
+void BlockPool<TYPE>::release(void) {
+	for (unsigned long i=0; i<m_blocks.size(); i++) {
+		delete [] m_blocks[i];
+	}
+	m_blocks.clear();
+	m_used = 0;
+}
+
+} // end rip namespace
+
+#endif /* _BLOCKPOOL_H */
+
+
+
@@ -0,0 +1,58 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 20:03:41 PDT 2026
+// Last Modified: Mon Oct 19 20:03:41 PDT 2026
+// Filename:      ChannelHistogram.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Histograms of 8-bit sample values for each color
+//                channel of an image.  Images are read in large blocks
+//                of rows, split across threads, and the per-thread
+//                histograms are merged.
+//
+
+#ifndef _CHANNELHISTOGRAM_H
+#define _CHANNELHISTOGRAM_H
+
+#include <vector>
+#include <string>
+
+#include "TiffFile.h"
+
+namespace rip  {
+
+class ChannelHistogram {
+	public:
+		                ChannelHistogram  (int channels = 3);
+		               ~ChannelHistogram  ();
+		void            clear             (void);
+		void            setChannelCount   (int channels);
+		int             getChannelCount   (void) const;
+		bool            readImage         (const std::string& filename, int threads = 0);
+		void            addPixels         (const ucharint* data, ulongint count);
+		void            addValues         (const ucharint* data, ulongint count,
+		                                   int channel = 0);
+		void            addValues         (const ucharint* data, const ucharint* types,
+		                                   ulongint count, int type, int channel = 0);
+		void            merge             (const ChannelHistogram& other);
+		ulongint        getCount          (int channel, int value) const;
+		ulongint        getTotal          (int channel) const;
+		const std::vector<ulongint>& getHistogram (int channel) const;
+		int             getOtsuThreshold  (int channel = 0) const;
+
+		static int      getThreadCount    (int threads, ulongint rows);
+
+	protected:
+		bool            readRows          (const std::string& filename,
+		                                   ulongint startrow, ulongint endrow);
+
+	private:
+		int                                 m_channels;
+		std::vector<std::vector<ulongint>>  m_counts;   // [channel][value]
+};
+
+} // end rip namespace
+
+#endif /* _CHANNELHISTOGRAM_H */
@@ -37,6 +37,12 @@ class CheckSum {
       string               getMD5Sum (vector<vector<unsigned char> >& data);
       void                 getMD5Sum (ostream& out, stringstream& data);
 
+      // incremental MD5 checksum of data given in several pieces:
+      void                 startMD5Sum  (void);
+      void                 updateMD5Sum (const unsigned char* data,
+                                         unsigned long size);
+      string               finishMD5Sum (void);
+
    protected:
 
       // md5sum calculation functions
@@ -51,6 +57,9 @@ class CheckSum {
       static void Decode       (unsigned long *output, unsigned char *input, 
                                 unsigned int len);
 
+   private:
+      MD5_CTX m_context;
+
 };
 
 
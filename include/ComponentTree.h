@@ -0,0 +1,86 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 21:10:27 PDT 2026
+// Last Modified: Mon Oct 19 21:10:27 PDT 2026
+// Filename:      ComponentTree.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Component tree (max-tree) of the bright regions of an
+//                image.  Each node is a connected region of pixels at or
+//                above a brightness level, so the regions (holes) found
+//                at any threshold can be read from the tree without
+//                filling the image again for each threshold.
+//
+
+#ifndef _COMPONENTTREE_H
+#define _COMPONENTTREE_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "Utilities.h"
+
+namespace rip  {
+
+// TREE_MAX_PIXELS: pixels are indexed with 32-bit integers (with
+// 0xffffffff reserved as a marker), so larger trees cannot be built.
+#define TREE_MAX_PIXELS 0xfffffffeULL
+
+// TREE_PIXEL_BYTES: memory needed for each pixel stored in the tree
+// while it is being built.
+#define TREE_PIXEL_BYTES 26
+
+class ComponentInfo {
+	public:
+		int         level;     // lowest brightness of pixels in the component
+		ulongint    area;      // number of pixels
+		ulongint    minrow;    // bounding box of the component
+		ulongint    maxrow;
+		ulongint    mincol;
+		ulongint    maxcol;
+		double      sumrow;    // sum of the rows and columns of the pixels
+		double      sumcol;    //    (divide by area for the centroid)
+};
+
+
+class ComponentTree {
+	public:
+		                ComponentTree      (void);
+		               ~ComponentTree      ();
+		void            clear              (void);
+		bool            build              (std::vector<std::vector<ucharint>>& image,
+		                                    ulongint startrow, ulongint endrow,
+		                                    std::vector<int>& startcols,
+		                                    std::vector<int>& endcols, int minlevel);
+		static ulonglongint countPixels    (std::vector<std::vector<ucharint>>& image,
+		                                    ulongint startrow, ulongint endrow,
+		                                    std::vector<int>& startcols,
+		                                    std::vector<int>& endcols, int minlevel);
+		void            getComponents      (std::vector<ComponentInfo>& output,
+		                                    int threshold, ulongint minarea = 0);
+		void            getThresholdCounts (std::vector<ulongint>& counts,
+		                                    std::vector<ulongint>& areas,
+		                                    ulongint minarea);
+		ulongint        getPixelCount      (void);
+		ulongint        getNodeCount       (void);
+
+	protected:
+		ulongint        findColumn         (ulongint row, uint32_t col, ulongint guess);
+		uint32_t        findRoot           (uint32_t index);
+
+	private:
+		int                        m_minlevel;
+		ulongint                   m_startrow;
+		std::vector<ulongint>      m_rowstart;   // index of first pixel in each row
+		std::vector<uint32_t>      m_col;        // column of each pixel
+		std::vector<ucharint>      m_value;      // brightness of each pixel
+		std::vector<uint32_t>      m_parent;     // parent pixel in the tree
+		std::vector<ComponentInfo> m_nodes;      // canonical nodes (children first)
+		std::vector<int>           m_nodeparent; // parent node of each node (-1 = root)
+};
+
+} // end rip namespace
+
+#endif /* _COMPONENTTREE_H */
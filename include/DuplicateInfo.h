@@ -0,0 +1,41 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 19:12:05 PDT 2026
+// Last Modified: Mon Oct 19 19:12:05 PDT 2026
+// Filename:      DuplicateInfo.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a run of duplicated rows (frames) in
+//                a roll image, such as caused by a scanner stall.
+//
+
+#ifndef _DUPLICATEINFO_H
+#define _DUPLICATEINFO_H
+
+#include <utility>
+#include <iostream>
+#include <string>
+
+namespace rip  {
+
+typedef unsigned long ulongint;
+
+class DuplicateInfo {
+	public:
+		         DuplicateInfo   (void);
+		        ~DuplicateInfo   ();
+		void     clear           (void);
+		std::ostream& printAton  (std::ostream& out);
+
+		std::string id;          // used for printing ATON data
+		ulongint    original;    // first row of the original frames
+		ulongint    duplicate;   // first row of the repeated frames
+		ulongint    rows;        // number of repeated rows
+};
+
+
+} // end rip namespace
+
+#endif /* _DUPLICATEINFO_H */
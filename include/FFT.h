@@ -23,7 +23,7 @@ namespace rip {
 
 #define two(x) (1 << (x))	 /* 2**x by left-shifting */
 
-void       FFT              (std::vector<mycomplex>& output, 
+bool       FFT              (std::vector<mycomplex>& output, 
                              std::vector<mycomplex>& input);
 void       shuffle          (std::vector<mycomplex>& X);
 void       dftmerge         (std::vector<mycomplex>& XF);
@@ -0,0 +1,68 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 19:12:05 PDT 2026
+// Last Modified: Mon Oct 19 19:12:05 PDT 2026
+// Filename:      FrameDuplicates.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Streaming detector for duplicated frames (runs of
+//                repeated rows) in a roll image.  Rows are given one at
+//                a time in order, and each window of frame-size rows is
+//                looked up by a rolling hash of the row checksums, so
+//                the image is examined in a single linear pass.
+//
+
+#ifndef _FRAMEDUPLICATES_H
+#define _FRAMEDUPLICATES_H
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "DuplicateInfo.h"
+
+namespace rip  {
+
+typedef unsigned long long ulonglongint;
+
+class FrameDuplicates {
+	public:
+		                 FrameDuplicates (ulongint framesize = 30);
+		                ~FrameDuplicates ();
+		void             clear           (void);
+		void             reserve         (ulongint rows);
+		void             setFrameSize    (ulongint rows);
+		ulongint         getFrameSize    (void);
+		void             addRow          (const void* data, ulongint bytes);
+		void             addRowChecksum  (uint32_t checksum);
+		void             finish          (void);
+		ulongint         getRowCount     (void);
+		std::vector<uint32_t>&      getRowChecksums (void);
+		std::vector<DuplicateInfo>& getDuplicates   (void);
+
+		static uint32_t  rowChecksum     (const void* data, ulongint bytes);
+
+	protected:
+		void             closeRun        (void);
+		bool             windowsMatch    (ulongint first, ulongint second);
+
+	private:
+		ulongint                   m_framesize;  // rows in a frame window
+		std::vector<uint32_t>      m_checksums;  // checksum of each row
+		// m_windows -- rolling hash of a window to the first row of the
+		// first window with that hash.
+		std::unordered_map<ulonglongint, ulongint> m_windows;
+		ulonglongint               m_hash;       // hash of the last m_framesize rows
+		ulonglongint               m_highpower;  // hash base to the m_framesize-1 power
+		ulongint                   m_samerows;   // trailing rows identical to the last row
+		ulongint                   m_nextwindow; // first window allowed to start a run
+		bool                       m_inrun;      // m_run is being extended
+		DuplicateInfo              m_run;
+		std::vector<DuplicateInfo> m_duplicates;
+};
+
+} // end rip namespace
+
+#endif /* _FRAMEDUPLICATES_H */
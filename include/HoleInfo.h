@@ -34,6 +34,20 @@ typedef unsigned long  ulongint;
 typedef unsigned short  ushort;
 typedef unsigned char  uchar;
 
+// HoleReason -- reason for a hole being rejected as a music hole.
+enum HoleReason {
+	HOLE_REASON_NONE = 0,
+	HOLE_REASON_SMALL,
+	HOLE_REASON_UNCENTERED,
+	HOLE_REASON_STRANGE,
+	HOLE_REASON_BASS_MARGIN,
+	HOLE_REASON_TREBLE_MARGIN,
+	HOLE_REASON_WIDE,
+	HOLE_REASON_ASPECT,
+	HOLE_REASON_SKEWED,
+	HOLE_REASON_OFF_TRACKER
+};
+
 class HoleInfo {
 	public:
 		         HoleInfo     (void);
@@ -43,6 +57,8 @@ class HoleInfo {
 		std::pair<ulongint, ulongint> width;    // Row, Column widths.
 		std::pair<double, double>     centroid; // Center of mass
 		std::pair<ulongint, ulongint> entry;    // entry point for filling holes
+		std::pair<ulongint, ulongint> imageorigin; // Row, Column of origin in image (if reoriented)
+		bool                      reoriented;   // true if image rows/columns differ from analysis
 		ulongint                  track;        // tracker hole index
 		ulongint                  area;         // area of hole
 		double                    circularity;  // circularity of hole
@@ -50,7 +66,9 @@ class HoleInfo {
 		double                    majoraxis;    // angle of longest axis
 		double                    coldrift;     // column drive in pixels
 		std::string               id;           // unique identifier (if not empty)
-		std::string               reason;       // reason for being a bad hole (if bad)
+		int                       idkey;        // key for generated identifier
+		ulongint                  idnumber;     // note number for generated identifier (if not 0)
+		HoleReason                reason;       // reason for being a bad hole (if bad)
 		double                    leadinghcor;  // leading horizontal pixel correction
 		double                    trailinghcor; // trailing horizontal pixel correction
 		double                    prevOff;      // distance from onset to offset of previous hole in track
@@ -62,6 +80,8 @@ class HoleInfo {
 		void     clear            (void);
 		bool     isMusicHole      (void) { return m_type == 1 ? 1 : 0; }
 		void     setNonHole       (void) { m_type = 0; }
+		std::string   getId       (void);
+		const char*   getReason   (void);
 		std::ostream& printAton   (std::ostream& out = std::cout);
 		bool      isShifting      (void);
 
@@ -0,0 +1,51 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 18:20:44 PDT 2026
+// Last Modified: Mon Oct 19 18:20:48 PDT 2026
+// Filename:      MemoryStream.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Seekable input stream over a caller-owned byte buffer
+//                (without copying the buffer).  Used to parse TIFF
+//                headers of images held in memory.
+//
+
+#ifndef _MEMORYSTREAM_H
+#define _MEMORYSTREAM_H
+
+#include <istream>
+#include <streambuf>
+
+#include "Utilities.h"
+
+namespace rip  {
+
+class MemoryStreamBuffer : public std::streambuf {
+	public:
+		               MemoryStreamBuffer  (const ucharint* data, ulonglongint size);
+
+	protected:
+		pos_type       seekoff             (off_type offset, std::ios_base::seekdir dir,
+		                                    std::ios_base::openmode which = std::ios_base::in);
+		pos_type       seekpos             (pos_type position,
+		                                    std::ios_base::openmode which = std::ios_base::in);
+};
+
+
+class MemoryStream : public std::istream {
+	public:
+		               MemoryStream        (const ucharint* data, ulonglongint size);
+		              ~MemoryStream        ();
+
+	private:
+		MemoryStreamBuffer m_buffer;
+};
+
+} // end rip namespace
+
+#endif /* _MEMORYSTREAM_H */
+
+
+
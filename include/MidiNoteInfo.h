@@ -0,0 +1,53 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 10:12:31 PDT 2026
+// Last Modified: Mon Oct 19 10:12:35 PDT 2026
+// Filename:      MidiNoteInfo.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a MIDI note generated from piano-roll holes.
+//
+
+#ifndef _MIDINOTEINFO_H
+#define _MIDINOTEINFO_H
+
+#include <iostream>
+
+namespace rip  {
+
+class MidiNoteInfo {
+	public:
+		         MidiNoteInfo  (void);
+		        ~MidiNoteInfo  ();
+		void     clear         (void);
+
+		int      track;
+		int      channel;
+		int      key;
+		int      velocity;
+		long     ontick;
+		long     offtick;
+
+		// endtick -- the note-off tick of the note which the hole belongs to
+		// after chained holes are grouped into notes (same as offtick otherwise).
+		long     endtick;
+
+		// attack -- true if the hole starts a new note.
+		bool     attack;
+
+		// expression -- true if the hole is in an expression region of the
+		// tracker bar rather than a note region.
+		bool     expression;
+};
+
+std::ostream& operator<<(std::ostream& out, MidiNoteInfo& ni);
+
+
+} // end rip namespace
+
+#endif /* _MIDINOTEINFO_H */
+
+
+
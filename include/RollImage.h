@@ -26,8 +26,15 @@
 
 #include "TiffFile.h"
 #include "HoleInfo.h"
+#include "BlockPool.h"
 #include "ShiftInfo.h"
+#include "SegmentInfo.h"
+#include "DuplicateInfo.h"
+#include "ChannelHistogram.h"
+#include "ComponentTree.h"
 #include "TearInfo.h"
+#include "MidiNoteInfo.h"
+#include "RollSummary.h"
 #include "RollOptions.h"
 
 #ifndef DONOTUSEFFT
@@ -82,23 +89,70 @@ namespace rip  {
 
 typedef unsigned char pixtype;
 
+// Handling of duplicated frames from scanner stalls (see
+// RollImage::setDuplicateFrames):
+enum DuplicateMode {
+	DUPLICATES_IGNORE = 0,  /* do not check for duplicate frames            */
+	DUPLICATES_MARK,        /* list duplicate frames in the analysis        */
+	DUPLICATES_DROP         /* remove duplicate frames before the analysis  */
+};
+
+// Analysis status (see RollImage::analyzeRoll and RollImage::getStatus):
+enum RollStatus {
+	ROLL_OK = 0,            /* analysis completed                           */
+	ROLL_ERROR_OPEN,        /* no image is open or it could not be parsed   */
+	ROLL_ERROR_ROLLTYPE,    /* unknown roll type                            */
+	ROLL_ERROR_LEADER,      /* leader is missing or at the bottom of image  */
+	ROLL_ERROR_ANALYSIS     /* analysis could not be completed              */
+};
+
 class RollImage : public TiffFile, public RollOptions {
 	public:
 		                 RollImage                    (void);
 		                ~RollImage                    ();
 
 		void	          loadGreenChannel              (int threshold);
+		bool            openSegments                  (const std::vector<std::string>& filenames);
+		int             getSegmentCount               (void);
 		void	          setMonochrome                 (bool value);
 		void            setRewindCorrection           (bool value);
 		void            toggleAccelerationEmulation   (bool value);
 		void            setMissingLeaders             (bool value);
+		void            setColumnMirror               (bool value);
+		void            setThreshold16                (int value);
+		void            setAutoThreshold              (bool value);
+		void            setDuplicateFrames            (DuplicateMode mode);
+		void            setLeanMemory                 (bool value);
+		void            setRowRange                   (ulongint startrow, ulongint endrow);
+		void            setLeaderOnly                 (bool value);
+		bool            hasRowRange                   (void);
+		void            getGreenHistogram             (ChannelHistogram& histogram,
+		                                               int pixtype = -1, int threads = 0);
+		bool            analyzeThresholdSweep         (int minthreshold, int maxthreshold);
+		bool            isReversed                    (void);
+		bool            isMirrored                    (void);
+		ulongint        getImageRow                   (ulongint row);
+		ulongint        getImageCol                   (ulongint col);
+		RollStatus      analyzeRoll                   (const std::string& rolltype,
+		                                               int threshold = 249);
+		RollStatus      getStatus                     (void);
+		std::string     getStatusMessage              (void);
 		void            analyze                       (void);
+		void            analyzeQuality                (void);
+		void            getAnalysisStepTimes          (std::vector<std::string>& names,
+		                                               std::vector<double>& seconds);
 		void            analyzeHoles                  (void);
-		void            mergePixelOverlay             (std::fstream& output);
+		bool            canMergePixelOverlay          (void);
+		bool            mergePixelOverlay             (std::fstream& output);
+		bool            writeStraightenedImage        (const std::string& filename,
+		                                               bool subpixel = false,
+		                                               int brightness = 254,
+		                                               int threads = 0);
 		void            markHoleBBs                   (void);
 		void            insertRollImageProperties     (MidiFile& midifile);
 		std::ostream&   printRollImageProperties      (std::ostream& out = std::cout);
 		std::ostream&   printQualityReport            (std::ostream& out = std::cerr);
+		RollSummary&    getRollSummary                (void);
 		int             getHardMarginLeftWidth        (void);
 		int             getHardMarginRightWidth       (void);
 		int             getHardMarginLeftIndex        (void);
@@ -127,6 +181,8 @@ class RollImage : public TiffFile, public RollOptions {
 		double          getDustScore                  (void);
 		double          getDustScoreBass              (void);
 		double          getDustScoreTreble            (void);
+		double          getDustScoreError             (void);
+		void            setDustSampling               (ulongint step);
 		void            sortBadHolesByArea            (void);
 		void            sortTearsByArea               (void);
 		void            sortShiftsByAmount            (void);
@@ -143,14 +199,20 @@ class RollImage : public TiffFile, public RollOptions {
 		void            generateNoteMidiFileBinasc    (ostream& output);
 		void            generateHoleMidiFileHex       (ostream& output);
 		void            generateHoleMidiFileBinasc    (ostream& output);
+		bool            writeNoteMidiFile             (ostream& output);
+		bool            writeHoleMidiFile             (ostream& output);
+		void            setEmbeddedMidiFiles          (bool value);
 		void            setAlignmentShift             (int trackerShift);
 
 #ifndef DONOTUSEFFT
 		void            generateMidifile              (MidiFile& midifile);
 		void            generateHoleMidifile          (MidiFile& midifile);
+		void            addSortedNotes                (MidiFile& midifile,
+		                                               std::vector<MidiNoteInfo>& notes);
 #endif
 
 		void            assignMidiKeyNumbersToHoles   (void);
+		void            buildMidiEventTable           (void);
 		void            setDebugOn                    (void);
 		void            setDebugOff                   (void);
 		void            setWarningOn                  (void);
@@ -196,9 +258,9 @@ class RollImage : public TiffFile, public RollOptions {
 		std::vector<HoleInfo*> holes;
 
 		// badHoles: Holes which were initially marked as music holes, but
-		// removed for some reason.  See also antidust.  Currently memory
-		// management of these holes is done in holes, but maybe move them
-		// here in the future and manage the memory here as well.
+		// removed for some reason.  See also antidust.  Memory for these
+		// holes (as well as holes and antidust) is owned by m_holePool,
+		// and for tears and shifts by m_tearPool and m_shiftPool.
 		std::vector<HoleInfo*> badHoles;
 
 		// antidust: List of holes on roll which are too small to be musical.
@@ -216,6 +278,10 @@ class RollImage : public TiffFile, public RollOptions {
 		// and rewind hole.
 		std::vector<int> trackMeaning;
 	
+		// midiEvents -- MIDI note information for each hole in holes
+		// (see buildMidiEventTable).
+		std::vector<MidiNoteInfo> midiEvents;
+
 		// midiEventCount -- 0 = no events, >0 = events (currently hole counts)
 		std::vector<int> midiEventCount;
 
@@ -233,8 +299,29 @@ class RollImage : public TiffFile, public RollOptions {
 		// operating the scanner.
 		std::vector<ShiftInfo*> shifts;
 
+		// segments -- files or pages which are stitched together to form
+		// the image when the roll was scanned in parts (see openSegments).
+		std::vector<SegmentInfo> segments;
+
+		// duplicates -- repeated frames in the image caused by scanner
+		// stalls (see setDuplicateFrames).
+		std::vector<DuplicateInfo> duplicates;
+
 
 	protected:
+		void       loadSegmentChannels         (std::vector<std::vector<ucharint>>* mask);
+		void       findDuplicateFrames         (std::vector<std::vector<ucharint>>* mask);
+		void       loadGreenChannelRows        (bool fullprecision);
+		bool       selectRowRange              (void);
+		void       releaseGreenChannel         (bool threshold);
+		void       getImageDrift               (std::vector<double>& drift,
+		                                        ulongint imagerows);
+		void       straightenRow               (ucharint* output, const ucharint* input,
+		                                        ulongint cols, double shift, bool subpixel,
+		                                        int brightness, TiffHeader& format);
+		ulongint   findSegmentOverlap          (std::vector<std::vector<ucharint>>& previous,
+		                                        std::vector<std::vector<ucharint>>& next,
+		                                        bool& ambiguous);
 		void       analyzeBasicMargins         (void);
 		void       analyzeAdvancedMargins      (void);
 		void       analyzeLeaders              (void);
@@ -262,9 +349,19 @@ class RollImage : public TiffFile, public RollOptions {
 		void       extractHole                 (ulongint row, ulongint col);
 		void       markPosteriorLeader         (void);
 		void       markHoleBB                  (HoleInfo& hi);
-		double     getTrackerShiftScore        (double shift);
+		void       getSparseCentroidHistogram  (std::vector<pair<int, int> >& bins,
+		                                        std::vector<int>& histogram);
+		void       getTrackerShiftScores       (std::vector<double>& scores,
+		                                        std::vector<pair<int, int> >& bins,
+		                                        double separation, double resolution);
+		double     getTrackerOffset            (std::vector<double>& scores,
+		                                        std::vector<pair<int, int> >& bins,
+		                                        double separation, double resolution);
 		void       analyzeTears                (void);
 		void       analyzeShifts               (void);
+		void       estimateMusicRows           (void);
+		double     countMarginDust             (ulongint startcol, ulongint endcol,
+		                                        double& error);
 		ulongint   storeShift                  (std::vector<double>& scores, ulongint startrow);
 		ulongint   findPeak                    (std::vector<double>& array, ulongint r,
 		                                        ulongint& peakindex, double& peakvalue);
@@ -306,7 +403,15 @@ class RollImage : public TiffFile, public RollOptions {
 		ulongint   storeWeightedCentroidGroup  (ulongint startindex);
 		void       storeCorrectedCentroidHistogram(void);
 		void       calculateTrackerSpacings2   (void);
+		void       analyzeTrackerSections      (void);
+		void       getLocalTrackerModel        (double row, double& separation,
+		                                        double& offset);
 		string     my_to_string                (int value);
+		void       setStatus                   (RollStatus status, const std::string& message);
+		void       reverseRows                 (void);
+		void       addImageOriginsToHoles      (void);
+		void       beginAnalysisStep           (int number, const std::string& name);
+		void       endAnalysisStep             (void);
 
 	private:
 
@@ -344,6 +449,12 @@ class RollImage : public TiffFile, public RollOptions {
 		double     m_dustscore;
 		double     m_dustscorebass;
 		double     m_dustscoretreble;
+		// m_dustscorebasserror, m_dustscoretrebleerror -- 95% confidence
+		// half-widths of the dust scores when only every m_dustSampleStep
+		// rows are counted (see setDustSampling).
+		double     m_dustscorebasserror;
+		double     m_dustscoretrebleerror;
+		ulongint   m_dustSampleStep;
 		double     m_averageHoleWidth;
 		double     m_interHoleCutoff;
 		bool       m_isMonochrome;
@@ -355,13 +466,75 @@ class RollImage : public TiffFile, public RollOptions {
 		// value, which is set from the command line.
 		int        m_trackerMapShift = 0;
 		bool       m_leadersAreMissing;
+		// m_reversedRows -- the leader was found at the bottom of the image,
+		// so the rows are analyzed in reverse order.
+		bool       m_reversedRows;
+		// m_mirroredCols -- the image is mirrored left to right (bass on the
+		// right side), so the columns are analyzed in reverse order.
+		bool       m_mirroredCols;
+		// m_threshold16 -- paper/hole threshold for 16-bit images at full
+		// precision (-1 to use the 8-bit threshold).
+		int        m_threshold16;
+		// m_autoThreshold -- choose the paper/hole threshold from the green
+		// histogram of the image rather than using the given threshold.
+		bool       m_autoThreshold;
+		// m_otsuThreshold -- true if the threshold was set by Otsu's method
+		// when loading the image (it is not when the green channel has fewer
+		// than two values).
+		bool       m_otsuThreshold;
+		// m_sweepHoles, m_sweepArea, m_sweepDust -- hole count, hole area and
+		// small-region count for each threshold from m_sweepMin to m_sweepMax
+		// (see analyzeThresholdSweep).
+		int        m_sweepMin;
+		int        m_sweepMax;
+		std::vector<ulongint> m_sweepHoles;
+		std::vector<ulongint> m_sweepArea;
+		std::vector<ulongint> m_sweepDust;
+		// m_duplicateMode -- check for (and possibly remove) duplicated
+		// frames when loading the image.
+		DuplicateMode m_duplicateMode;
+		// m_leanMemory -- do not keep the monochrome image after loading it
+		// (see setLeanMemory).
+		bool       m_leanMemory;
+		// m_channelMD5 -- MD5 checksum of the monochrome image in the row
+		// and column order of the input image, calculated while loading it.
+		std::string m_channelMD5;
+		// m_startRow, m_endRow -- range of input image rows to analyze,
+		// with m_endRow = 0 for the end of the image (see setRowRange).
+		// m_rowRange is true when the range does not cover the whole image.
+		ulongint   m_startRow;
+		ulongint   m_endRow;
+		bool       m_leaderOnly;
+		bool       m_rowRange;
+		bool       m_embedMidiFiles;
+		RollSummary m_summary;
+		RollStatus  m_status;
+		std::string m_statusMessage;
+
+		// m_holePool -- block storage for holes, badHoles and antidust.
+		BlockPool<HoleInfo>  m_holePool;
+		// m_tearPool -- block storage for bassTears and trebleTears.
+		BlockPool<TearInfo>  m_tearPool;
+		// m_shiftPool -- block storage for shifts.
+		BlockPool<ShiftInfo> m_shiftPool;
 
 #ifndef DONOTUSEFFT
 		std::chrono::system_clock::time_point start_time;
 		std::chrono::system_clock::time_point stop_time;
+		std::chrono::steady_clock::time_point m_stepStart;
 #endif
+		// m_stepNames, m_stepTimes -- analysis steps and their durations
+		// in seconds from the last call to analyze().
+		std::vector<std::string> m_stepNames;
+		std::vector<double> m_stepTimes;
 		std::vector<double> m_normalizedPosition;
 		std::vector<double> m_trackerShiftScores;
+		// m_sectionRow, m_sectionSeparation, m_sectionOffset -- the center
+		// rows of the windows used to model the tracker-bar separation and
+		// offset along the length of the roll (see analyzeTrackerSections).
+		std::vector<ulongint> m_sectionRow;
+		std::vector<double>   m_sectionSeparation;
+		std::vector<double>   m_sectionOffset;
 
 };
 
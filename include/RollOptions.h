@@ -49,6 +49,7 @@ class RollOptions {
 		void     hasExpressionMidiFileSetup   (void);
 
 		std::string getRollType               (void);
+		bool     setRollType                  (const std::string& name);
 		void     setRollTypeRedWelte          (void);
 		void     setRollTypeGreenWelte        (void);
 		void     setRollTypeLicenseeWelte     (void);
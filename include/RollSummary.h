@@ -0,0 +1,58 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 14:20:18 PDT 2026
+// Last Modified: Mon Oct 19 14:20:22 PDT 2026
+// Filename:      RollSummary.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Summary statistics of an analyzed piano roll which are
+//                used in the analysis report, MIDI file metadata and the
+//                quality report.
+//
+
+#ifndef _ROLLSUMMARY_H
+#define _ROLLSUMMARY_H
+
+#include <string>
+
+namespace rip  {
+
+class RollSummary {
+	public:
+		         RollSummary   (void);
+		        ~RollSummary   ();
+		void     clear         (void);
+
+		// valid -- true if the summary has been calculated for the
+		// current analysis.
+		bool        valid;
+
+		double      rollwidth;       // average roll width (rounded to 1/100 px)
+		double      softmarginsum;   // average soft margin total (rounded to 1/100 px)
+		int         bassdriftmax;    // maximum bass soft margin width
+		int         trebledriftmax;  // maximum treble soft margin width
+		double      driftmin;        // minimum drift correction in music region
+		double      driftmax;        // maximum drift correction in music region
+		double      driftrange;      // driftmax - driftmin
+		int         musiclength;     // rows from first to last music hole
+		double      holewidth;       // average musical hole width (rounded to 1/100 px)
+		unsigned long notecount;     // number of holes which are note attacks
+		int         trackerholes;    // expected (or measured) tracker hole count
+		std::string trackerstring;   // trackerholes with "(estimate)" if measured
+		double      dustscore;       // dust score of both hard margins (ppm)
+		double      dustscorebass;   // dust score of bass hard margin (ppm)
+		double      dustscoretreble; // dust score of treble hard margin (ppm)
+		double      dustscoreerror;  // 95% confidence half-width of dustscore (ppm)
+		double      maxshift;        // largest absolute shift in pixels
+		std::string md5sum;          // MD5 checksum of the image channel
+};
+
+
+} // end rip namespace
+
+#endif /* _ROLLSUMMARY_H */
+
+
+
@@ -0,0 +1,43 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 18:20:44 PDT 2026
+// Last Modified: Mon Oct 19 18:20:44 PDT 2026
+// Filename:      SegmentInfo.h
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a segment (file or page) of a roll
+//                image which was scanned in several parts.
+//
+
+#ifndef _SEGMENTINFO_H
+#define _SEGMENTINFO_H
+
+#include <utility>
+#include <iostream>
+#include <string>
+
+namespace rip  {
+
+typedef unsigned long ulongint;
+
+class SegmentInfo {
+	public:
+		         SegmentInfo   (void);
+		        ~SegmentInfo   ();
+		void     clear         (void);
+		std::ostream& printAton(std::ostream& out);
+
+		std::string filename;   // file containing the segment
+		int         page;       // page (image directory) in the file
+		ulongint    startrow;   // first row of segment in the stitched image
+		ulongint    rows;       // rows used from the segment
+		ulongint    overlap;    // rows at start of segment dropped as overlap
+		bool        ambiguous;  // overlap could not be identified (rows kept)
+};
+
+
+} // end rip namespace
+
+#endif /* _SEGMENTINFO_H */
@@ -32,24 +32,63 @@ class TiffFile : public std::fstream, public TiffHeader {
 
 		void        close                       (void);
 		bool        open                        (const std::string& filename);
+		bool        openMemory                  (const ucharint* data, ulonglongint size,
+		                                         const std::string& name = "");
+		bool        openStream                  (std::istream& input,
+		                                         const std::string& name = "");
+		bool        openFileDescriptor          (int fd, const std::string& name = "");
+		bool        openMapped                  (const std::string& filename);
+		bool        isMemoryInput               (void);
+		bool        openInput                   (TiffFile& source);
+		ulonglongint getInputSize              (void);
+		bool        readBytes                   (ucharint* buffer, ulonglongint offset,
+		                                         ulonglongint count);
 		bool        goToByteIndex               (ulonglongint offset);
 		ushortint   readLittleEndian2ByteUInt   (void);
 		std::string readString                  (ulongint count);
 		ucharint    read1UByte                  (void);
-		void        getImageGreenChannel        (std::vector<std::vector<ucharint> >& image);
-		void        getImageChannel             (std::vector<std::vector<ucharint> >& image);
+		void        getImageGreenChannel        (std::vector<std::vector<ucharint> >& image,
+		                                         std::vector<std::vector<ucharint> >* mask = NULL,
+		                                         ushortint threshold16 = 0);
+		void        getImageChannel             (std::vector<std::vector<ucharint> >& image,
+		                                         std::vector<std::vector<ucharint> >* mask = NULL,
+		                                         ushortint threshold16 = 0);
 		bool        goToPixelIndex              (ulonglongint pindex);
 		bool        goToRowColumnIndex          (ulongint rowindex, ulongint colindex);
 		std::string getFilename                 (void);
+		int         getPageCount                (void);
+		bool        selectPage                  (int page);
 
 		// header updates on disk
 		bool        writeSamplesPerPixel        (int count);
 		void        writeDirectoryOffset        (ulonglongint offset);
 
+	protected:
+		bool        parseMemory                 (const ucharint* data, ulonglongint size,
+		                                         const std::string& name);
+		bool        checkMemoryData             (void);
+		void        readImageChannel            (std::vector<std::vector<ucharint> >& image,
+		                                         int channel,
+		                                         std::vector<std::vector<ucharint> >* mask,
+		                                         ushortint threshold16,
+		                                         ulongint startrow, ulongint endrow);
+		void        convertSamples              (const ucharint* data, ulongint count,
+		                                         int spp, int channel, ucharint* output,
+		                                         ucharint* mask, ushortint threshold16);
+
 	private:
 		std::string m_filename;
 		// std::fstream m_input;
 
+		// m_memory -- image bytes when the input is in memory rather than
+		// read through the fstream (see openMemory).  Points either to
+		// caller-owned data, m_memoryBuffer, or the mapping m_mapped.
+		const ucharint*       m_memory = NULL;
+		ulonglongint          m_memorySize = 0;
+		std::vector<ucharint> m_memoryBuffer;
+		void*                 m_mapped = NULL;
+		ulonglongint          m_mappedSize = 0;
+
 };
 
 } // end rip namespace
@@ -39,17 +39,29 @@ class TiffHeader {
 		double         getColDpi           (void) const;
 		ulonglongint   getPixelOffset      (ulonglongint pindex) const;
 		ulonglongint   getPixelOffset      (ulongint rindex, ulongint cindex) const;
+		ulonglongint   getSampleOffset     (ulongint rindex, ulongint cindex,
+		                                    int channel) const;
 		ulonglongint   getPixelCount       (void) const;
 		void           setBigTiff          (void);
 		bool           isBigTiff           (void);
-		bool           parseHeader         (std::fstream& input);
+		bool           parseHeader         (std::istream& input);
 		void           allowMonochrome     (bool state = true);
 		bool           isMonochrome        (void) const;
+		int            getSamplesPerPixel  (void) const;
+		int            getBitsPerSample    (void) const;
+		int            getBytesPerPixel    (void) const;
+		bool           isBigEndian         (void) const;
+		bool           isPlanar            (void) const;
+		ulonglongint   getPlaneOffset      (int channel) const;
 		ulonglongint   getDirectoryOffset  (void) const;
+		int            countPages          (std::istream& input);
+		bool           parsePage           (std::istream& input, int page);
+		bool           isReducedImage      (void) const;
 
 	protected:
 		void           setOrientation      (int value);
 		void           setSamplesPerPixel  (int value);
+		void           setBitsPerSample    (int value);
 		void           setRows             (ulongint value);
 		void           setCols             (ulongint value);
 		void           setRowDpi           (double value);
@@ -63,18 +75,32 @@ class TiffHeader {
 		void           writeEntryUInteger  (std::fstream& output, int datatype,
 		                                    ulonglongint count, int tag, ulonglongint value);
 
-		ulonglongint   readEntryUInteger   (std::fstream& input, int datatype, ulonglongint count, int tag = -1);
-		double         readType5Value      (std::fstream& input, int datatype, ulonglongint count, int tag = -1);
-		std::string    readType2String     (std::fstream& input, int datatype, ulonglongint count, int tag = -1);
-		std::string    readType1ByteArray  (std::fstream& input, int datatype, ulonglongint count, int tag = -1);
-		bool           goToByteIndex       (std::fstream& input, ulongint offset);
-		bool           goToByteIndex       (std::fstream& input, ulonglongint offset);
+		ulonglongint   readEntryUInteger   (std::istream& input, int datatype, ulonglongint count, int tag = -1);
+		ulongint       readBitsPerSample   (std::istream& input, int datatype, ulonglongint count);
+		ulonglongint   readArrayValue      (std::istream& input, int datatype, ulonglongint count,
+		                                    ulonglongint index);
+		bool           readPlaneOffsets    (std::istream& input);
+		void           clearImageFields    (void);
+		ulonglongint   readNextDirectoryOffset(std::istream& input, ulonglongint diroffset);
+
+		// reading/writing integers in the byte order of the file:
+		ushortint      read2ByteUInt       (std::istream& input);
+		ulongint       read4ByteUInt       (std::istream& input);
+		ulonglongint   read8ByteUInt       (std::istream& input);
+		void           write2ByteUInt      (std::ostream& output, ushortint value);
+		void           write4ByteUInt      (std::ostream& output, ulongint value);
+		void           write8ByteUInt      (std::ostream& output, ulonglongint value);
+		double         readType5Value      (std::istream& input, int datatype, ulonglongint count, int tag = -1);
+		std::string    readType2String     (std::istream& input, int datatype, ulonglongint count, int tag = -1);
+		std::string    readType1ByteArray  (std::istream& input, int datatype, ulonglongint count, int tag = -1);
+		bool           goToByteIndex       (std::istream& input, ulongint offset);
+		bool           goToByteIndex       (std::istream& input, ulonglongint offset);
 
 		void           writeDirectoryOffset(std::ostream& output, ulonglongint offset);
 
 	private:
-		bool           parseDirectory      (std::fstream& input, ulonglongint diroffset);
-		bool           readDirectoryEntry  (std::fstream& input);
+		bool           parseDirectory      (std::istream& input, ulonglongint diroffset);
+		bool           readDirectoryEntry  (std::istream& input);
 
 	private:
 
@@ -89,6 +115,9 @@ class TiffHeader {
 
 		bool           m_allowMonochrome = false;
 
+		// m_parseError -- set when a header entry cannot be read.
+		bool           m_parseError = false;
+
 		ulongint       m_rows;
 		ulongint       m_cols;
 		int            m_orientation;
@@ -98,6 +127,16 @@ class TiffHeader {
 		double         m_coldpi;
 		bool           m_64bitQ;
 		int            m_samplesperpixel;
+		int            m_bitspersample;
+		// m_bigEndian -- byte order of the file ("MM"), also used for
+		// 16-bit samples.
+		bool           m_bigEndian;
+		// m_planar -- samples are stored in separate planes rather than
+		// interleaved, with m_planeoffsets the start of each plane.
+		bool           m_planar;
+		std::vector<ulonglongint> m_planeoffsets;
+		// m_subfiletype -- NewSubfileType of the directory (1 = reduced image).
+		ulongint       m_subfiletype;
 
 		// (first) directory offset: byte location of header information
 		ulonglongint   m_diroffset = 0;
@@ -108,6 +147,11 @@ class TiffHeader {
 		// store offsets for later updating
 		ulonglongint   m_samplesperpixel_offset = 0;
 
+		// location of the strip offsets entry (for planar images)
+		ulonglongint   m_stripoffsets_entry = 0;
+		int            m_stripoffsets_type  = 0;
+		ulonglongint   m_stripoffsets_count = 0;
+
 	friend TiffFile;
 };
 
@@ -40,6 +40,9 @@ typedef unsigned char ucharint;
 ulonglongint   readLittleEndian8ByteUInt  (std::istream& input);
 ulongint       readLittleEndian4ByteUInt  (std::istream& input);
 ushortint      readLittleEndian2ByteUInt  (std::istream& input);
+ulonglongint   readBigEndian8ByteUInt     (std::istream& input);
+ulongint       readBigEndian4ByteUInt     (std::istream& input);
+ushortint      readBigEndian2ByteUInt     (std::istream& input);
 ucharint       read1UByte                 (std::istream& input);
 std::string    readString                 (std::istream& input, int count);
 
@@ -47,6 +50,9 @@ std::string    readString                 (std::istream& input, int count);
 void           writeLittleEndian8ByteUInt (std::ostream& output, ulonglongint);
 void           writeLittleEndian4ByteUInt (std::ostream& output, ulongint);
 void           writeLittleEndian2ByteUInt (std::ostream& output, ushortint);
+void           writeBigEndian8ByteUInt    (std::ostream& output, ulonglongint);
+void           writeBigEndian4ByteUInt    (std::ostream& output, ulongint);
+void           writeBigEndian2ByteUInt    (std::ostream& output, ushortint);
 void           write1UByte                (std::ostream& output, ucharint);
 void           writeString                (std::ostream& output, std::string data);
 
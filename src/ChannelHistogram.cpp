@@ -0,0 +1,424 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 20:03:41 PDT 2026
+// Last Modified: Mon Oct 19 20:03:41 PDT 2026
+// Filename:      ChannelHistogram.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Histograms of 8-bit sample values for each color
+//                channel of an image.
+//
+// Samples are counted into four banks of histograms in turn, so that long
+// runs of the same value (which are common for paper and backlight) do not
+// wait on the increment of the same counter for the previous sample.  The
+// banks are added into the histograms at the end of each block.
+//
+
+#include "ChannelHistogram.h"
+
+#include <thread>
+#include <algorithm>
+
+namespace rip  {
+
+// number of histogram banks used while counting:
+#define HISTOGRAM_BANKS 4
+
+// largest number of samples counted before the banks are added to the
+// histograms (so that the 32-bit bank counters cannot overflow):
+#define HISTOGRAM_BLOCK 0x40000000
+
+// approximate size in bytes of the blocks of rows read from a file:
+#define HISTOGRAM_READ_BYTES (16 * 1024 * 1024)
+
+
+//////////////////////////////
+//
+// ChannelHistogram::ChannelHistogram --
+//     default value: channels = 3
+//
+
+ChannelHistogram::ChannelHistogram(int channels) {
+	setChannelCount(channels);
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::~ChannelHistogram --
+//
+
+ChannelHistogram::~ChannelHistogram() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::clear -- Set all counts to zero.
+//
+
+void ChannelHistogram::clear(void) {
+	for (ulongint i=0; i<m_counts.size(); i++) {
+		std::fill(m_counts[i].begin(), m_counts[i].end(), 0);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::setChannelCount -- Set the number of color channels
+//     (samples per pixel) and clear the counts.
+//
+
+void ChannelHistogram::setChannelCount(int channels) {
+	m_channels = channels < 1 ? 1 : channels;
+	m_counts.resize(m_channels);
+	for (ulongint i=0; i<m_counts.size(); i++) {
+		m_counts[i].resize(256);
+	}
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getChannelCount --
+//
+
+int ChannelHistogram::getChannelCount(void) const {
+	return m_channels;
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::readImage -- Count the samples of an uncompressed 8-bit
+//     TIFF image with interleaved channels.  The image is split into
+//     ranges of rows which are read by separate threads (0 = one for each
+//     processor).
+//     default value: threads = 0
+//
+
+bool ChannelHistogram::readImage(const std::string& filename, int threads) {
+	TiffFile tfile;
+	if (!tfile.open(filename)) {
+		return false;
+	}
+	if ((tfile.getBitsPerSample() != 8) || (tfile.isPlanar() && !tfile.isMonochrome())) {
+		std::cerr << "Can only read histograms from 8-bit images with interleaved samples"
+		          << std::endl;
+		return false;
+	}
+	ulongint rows = tfile.getRows();
+	setChannelCount(tfile.getSamplesPerPixel());
+	tfile.close();
+
+	threads = getThreadCount(threads, rows);
+	std::vector<ChannelHistogram> partial(threads, ChannelHistogram(m_channels));
+	std::vector<char> status(threads, 1);
+	std::vector<std::thread> workers;
+	for (int t=0; t<threads; t++) {
+		ulongint startrow = rows * t / threads;
+		ulongint endrow   = rows * (t + 1) / threads;
+		workers.emplace_back([&partial, &status, &filename, t, startrow, endrow]() {
+			status[t] = partial[t].readRows(filename, startrow, endrow);
+		});
+	}
+	for (ulongint t=0; t<workers.size(); t++) {
+		workers[t].join();
+	}
+
+	for (int t=0; t<threads; t++) {
+		if (!status[t]) {
+			clear();
+			return false;
+		}
+		merge(partial[t]);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::readRows -- Count the samples in a range of rows of an
+//     image file, reading blocks of rows at a time.
+//
+
+bool ChannelHistogram::readRows(const std::string& filename, ulongint startrow,
+		ulongint endrow) {
+	if (startrow >= endrow) {
+		return true;
+	}
+	TiffFile tfile;
+	if (!tfile.open(filename)) {
+		return false;
+	}
+	ulongint rowbytes = tfile.getCols() * tfile.getBytesPerPixel();
+	ulongint blockrows = std::max((ulongint)1, (ulongint)HISTOGRAM_READ_BYTES / rowbytes);
+	std::vector<ucharint> block(std::min(blockrows, endrow - startrow) * rowbytes);
+
+	tfile.goToByteIndex(tfile.getDataOffset() + (ulonglongint)startrow * rowbytes);
+	for (ulongint r=startrow; r<endrow; r+=blockrows) {
+		ulongint count = std::min(blockrows, endrow - r);
+		tfile.read((char*)block.data(), count * rowbytes);
+		if (!tfile.good()) {
+			std::cerr << "Cannot read image data at row " << r << std::endl;
+			return false;
+		}
+		addPixels(block.data(), count * tfile.getCols());
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::addPixels -- Count pixels with interleaved samples for
+//     each channel.
+//
+
+void ChannelHistogram::addPixels(const ucharint* data, ulongint count) {
+	int spp = m_channels;
+	std::vector<uint32_t> counts(HISTOGRAM_BANKS * spp * 256);
+
+	while (count > 0) {
+		ulongint blocksize = std::min(count, (ulongint)HISTOGRAM_BLOCK);
+		std::fill(counts.begin(), counts.end(), 0);
+		uint32_t* bank0 = counts.data();
+		uint32_t* bank1 = bank0 + spp * 256;
+		uint32_t* bank2 = bank1 + spp * 256;
+		uint32_t* bank3 = bank2 + spp * 256;
+		ulongint i = 0;
+		for ( ; i + HISTOGRAM_BANKS <= blocksize; i += HISTOGRAM_BANKS) {
+			const ucharint* p = data + i * spp;
+			for (int c=0; c<spp; c++) {
+				bank0[c * 256 + p[c]]++;
+				bank1[c * 256 + p[spp + c]]++;
+				bank2[c * 256 + p[2 * spp + c]]++;
+				bank3[c * 256 + p[3 * spp + c]]++;
+			}
+		}
+		for ( ; i<blocksize; i++) {
+			for (int c=0; c<spp; c++) {
+				bank0[c * 256 + data[i * spp + c]]++;
+			}
+		}
+		for (int c=0; c<spp; c++) {
+			for (int v=0; v<256; v++) {
+				ulongint index = c * 256 + v;
+				m_counts[c][v] += (ulongint)bank0[index] + bank1[index]
+						+ bank2[index] + bank3[index];
+			}
+		}
+		data  += blocksize * spp;
+		count -= blocksize;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::addValues -- Count the values of a single channel.  If
+//     types is given, only count the values at positions where the type
+//     matches the given type (such as a PIX_PAPER pixel type).
+//     default value: channel = 0
+//
+
+void ChannelHistogram::addValues(const ucharint* data, ulongint count, int channel) {
+	if ((channel < 0) || (channel >= m_channels)) {
+		return;
+	}
+	uint32_t banks[HISTOGRAM_BANKS][256] = {{0}};
+	while (count > 0) {
+		ulongint blocksize = std::min(count, (ulongint)HISTOGRAM_BLOCK);
+		ulongint i = 0;
+		for ( ; i + HISTOGRAM_BANKS <= blocksize; i += HISTOGRAM_BANKS) {
+			banks[0][data[i]]++;
+			banks[1][data[i+1]]++;
+			banks[2][data[i+2]]++;
+			banks[3][data[i+3]]++;
+		}
+		for ( ; i<blocksize; i++) {
+			banks[0][data[i]]++;
+		}
+		for (int v=0; v<256; v++) {
+			m_counts[channel][v] += (ulongint)banks[0][v] + banks[1][v]
+					+ banks[2][v] + banks[3][v];
+			banks[0][v] = banks[1][v] = banks[2][v] = banks[3][v] = 0;
+		}
+		data  += blocksize;
+		count -= blocksize;
+	}
+}
+
+
+void ChannelHistogram::addValues(const ucharint* data, const ucharint* types,
+		ulongint count, int type, int channel) {
+	if ((channel < 0) || (channel >= m_channels)) {
+		return;
+	}
+	std::vector<ulongint>& histogram = m_counts[channel];
+	for (ulongint i=0; i<count; i++) {
+		if (types[i] == type) {
+			histogram[data[i]]++;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::merge -- Add the counts of another histogram with the
+//     same number of channels.
+//
+
+void ChannelHistogram::merge(const ChannelHistogram& other) {
+	int channels = std::min(m_channels, other.m_channels);
+	for (int c=0; c<channels; c++) {
+		for (int v=0; v<256; v++) {
+			m_counts[c][v] += other.m_counts[c][v];
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getCount -- Return the number of samples in a channel
+//     with the given value.
+//
+
+ulongint ChannelHistogram::getCount(int channel, int value) const {
+	if ((channel < 0) || (channel >= m_channels) || (value < 0) || (value > 255)) {
+		return 0;
+	}
+	return m_counts[channel][value];
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getTotal -- Return the number of samples counted in a
+//     channel.
+//
+
+ulongint ChannelHistogram::getTotal(int channel) const {
+	ulongint sum = 0;
+	if ((channel < 0) || (channel >= m_channels)) {
+		return sum;
+	}
+	for (int v=0; v<256; v++) {
+		sum += m_counts[channel][v];
+	}
+	return sum;
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getHistogram -- Return the 256 counts of a channel.
+//
+
+const std::vector<ulongint>& ChannelHistogram::getHistogram(int channel) const {
+	if ((channel < 0) || (channel >= m_channels)) {
+		channel = 0;
+	}
+	return m_counts[channel];
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getOtsuThreshold -- Return the value which best
+//     separates the samples of a channel into a dark and a bright class
+//     (Otsu's method: maximum variance between the classes).  The value is
+//     the smallest sample value in the bright class, or -1 if the channel
+//     has fewer than two distinct values.
+//     default value: channel = 0
+//
+
+int ChannelHistogram::getOtsuThreshold(int channel) const {
+	if ((channel < 0) || (channel >= m_channels)) {
+		return -1;
+	}
+	const std::vector<ulongint>& histogram = m_counts[channel];
+	double total = 0.0;
+	double sum = 0.0;
+	for (int v=0; v<256; v++) {
+		total += histogram[v];
+		sum   += (double)v * histogram[v];
+	}
+
+	// Values with no samples between the classes give the same variance,
+	// so the middle of the range of best values is used.
+	int output = -1;
+	int lastbest = -1;
+	double best = 0.0;
+	double darkcount = 0.0;
+	double darksum = 0.0;
+	for (int v=0; v<255; v++) {
+		darkcount += histogram[v];
+		darksum   += (double)v * histogram[v];
+		double brightcount = total - darkcount;
+		if ((darkcount == 0.0) || (brightcount == 0.0)) {
+			continue;
+		}
+		double darkmean = darksum / darkcount;
+		double brightmean = (sum - darksum) / brightcount;
+		double variance = darkcount * brightcount * (darkmean - brightmean) * (darkmean - brightmean);
+		if (variance > best * (1.0 + 1e-12)) {
+			best = variance;
+			output = v + 1;
+			lastbest = v + 1;
+		} else if (variance >= best * (1.0 - 1e-12)) {
+			lastbest = v + 1;
+		}
+	}
+	if (output < 0) {
+		return output;
+	}
+	return (output + lastbest) / 2;
+}
+
+
+
+//////////////////////////////
+//
+// ChannelHistogram::getThreadCount -- Return the number of threads to use
+//     for the given requested count (0 or less for one per processor) and
+//     the number of rows in the image.
+//
+
+int ChannelHistogram::getThreadCount(int threads, ulongint rows) {
+	if (threads <= 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+	if (threads <= 0) {
+		threads = 1;
+	}
+	if ((ulongint)threads > rows) {
+		threads = rows > 0 ? (int)rows : 1;
+	}
+	return threads;
+}
+
+
+
+} // end rip namespace
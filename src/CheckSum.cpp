@@ -550,3 +550,54 @@ void CheckSum::getMD5Sum(ostream& out, stringstream& data) {
 
 
 
+//////////////////////////////
+//
+// CheckSum::startMD5Sum -- Start an MD5 checksum which is calculated
+//     from data given in several pieces to updateMD5Sum(), such as the
+//     rows of an image as they are read.
+//
+
+void CheckSum::startMD5Sum(void) {
+	MD5Init(&m_context);
+}
+
+
+
+//////////////////////////////
+//
+// CheckSum::updateMD5Sum -- Add data to the checksum started with
+//     startMD5Sum().
+//
+
+void CheckSum::updateMD5Sum(const unsigned char* data, unsigned long size) {
+	while (size > 0) {
+		unsigned int count = size > 0x10000000 ? 0x10000000 : size;
+		MD5Update(&m_context, (unsigned char*)data, count);
+		data += count;
+		size -= count;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// CheckSum::finishMD5Sum -- Return the MD5 checksum of the data given to
+//     updateMD5Sum() since startMD5Sum(), as hex digits.
+//
+
+string CheckSum::finishMD5Sum(void) {
+	stringstream outvalue;
+	unsigned char digest[16] = {0};
+	MD5Final(digest, &m_context);
+	for (int i=0; i<16; i++) {
+		if ((int)digest[i] < 16) {
+			outvalue << "0";
+		}
+		outvalue << hex << (int)digest[i] << dec;
+	}
+	return outvalue.str();
+}
+
+
+
@@ -0,0 +1,453 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 21:10:27 PDT 2026
+// Last Modified: Mon Oct 19 21:10:27 PDT 2026
+// Filename:      ComponentTree.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Component tree (max-tree) of the bright regions of an
+//                image.
+//
+// The tree is built with union-find: pixels are added from brightest to
+// darkest, and each new pixel becomes the parent of the regions of its
+// (8-connected) neighbors which were already added (see Berger, et al.,
+// "Effective component tree computation with application to pattern
+// recognition in astronomical imaging", 2007).  Only pixels at or
+// above the minimum level are stored, so the memory used depends on the
+// size of the holes rather than the size of the image.
+//
+
+#include "ComponentTree.h"
+
+#include <algorithm>
+
+namespace rip  {
+
+// marker for pixels not yet added to the tree:
+#define TREE_UNSET 0xffffffff
+
+
+//////////////////////////////
+//
+// ComponentTree::ComponentTree --
+//
+
+ComponentTree::ComponentTree(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::~ComponentTree --
+//
+
+ComponentTree::~ComponentTree() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::clear --
+//
+
+void ComponentTree::clear(void) {
+	m_minlevel = 0;
+	m_startrow = 0;
+	m_rowstart.clear();
+	m_col.clear();
+	m_value.clear();
+	m_parent.clear();
+	m_nodes.clear();
+	m_nodeparent.clear();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::countPixels -- Return the number of pixels which build()
+//     would store in the tree (about TREE_PIXEL_BYTES of memory each).
+//
+
+ulonglongint ComponentTree::countPixels(std::vector<std::vector<ucharint>>& image,
+		ulongint startrow, ulongint endrow, std::vector<int>& startcols,
+		std::vector<int>& endcols, int minlevel) {
+	ulonglongint count = 0;
+	for (ulongint r=startrow; r<endrow; r++) {
+		int startcol = std::max(0, startcols[r]);
+		int endcol = std::min((int)image[r].size(), endcols[r]);
+		for (int c=startcol; c<endcol; c++) {
+			if (image[r][c] >= minlevel) {
+				count++;
+			}
+		}
+	}
+	return count;
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::build -- Build the tree for the pixels of the image with
+//     a value of at least minlevel, in the rows from startrow to endrow
+//     (exclusive), and for each row r in the columns from startcols[r]
+//     to endcols[r] (exclusive).  Returns false (with an empty tree) if
+//     there are more than TREE_MAX_PIXELS pixels to store.
+//
+
+bool ComponentTree::build(std::vector<std::vector<ucharint>>& image,
+		ulongint startrow, ulongint endrow, std::vector<int>& startcols,
+		std::vector<int>& endcols, int minlevel) {
+	clear();
+	m_minlevel = minlevel;
+	m_startrow = startrow;
+	if (endrow <= startrow) {
+		m_rowstart.push_back(0);
+		return true;
+	}
+	ulonglongint total = countPixels(image, startrow, endrow, startcols,
+			endcols, minlevel);
+	if (total > TREE_MAX_PIXELS) {
+		m_rowstart.push_back(0);
+		return false;
+	}
+
+	// Store the pixels to be placed in the tree in row order:
+	m_col.reserve(total);
+	m_value.reserve(total);
+	m_rowstart.resize(endrow - startrow + 1);
+	for (ulongint r=startrow; r<endrow; r++) {
+		m_rowstart[r - startrow] = m_col.size();
+		int startcol = std::max(0, startcols[r]);
+		int endcol = std::min((int)image[r].size(), endcols[r]);
+		for (int c=startcol; c<endcol; c++) {
+			if (image[r][c] >= minlevel) {
+				m_col.push_back(c);
+				m_value.push_back(image[r][c]);
+			}
+		}
+	}
+	m_rowstart.back() = m_col.size();
+	ulongint count = m_col.size();
+
+	// Sort the pixels from brightest to darkest:
+	std::vector<ulongint> bucket(257, 0);
+	for (ulongint i=0; i<count; i++) {
+		bucket[255 - m_value[i] + 1]++;
+	}
+	for (int i=1; i<257; i++) {
+		bucket[i] += bucket[i-1];
+	}
+	std::vector<uint32_t> order(count);
+	for (ulongint i=0; i<count; i++) {
+		order[bucket[255 - m_value[i]]++] = i;
+	}
+
+	// Add the pixels to the tree.  zpar holds the union-find sets (merged
+	// by rank to keep them shallow), and repr is the most recently added
+	// pixel of each set, which is the top of its region in the tree:
+	m_parent.resize(count);
+	std::vector<uint32_t>& zpar = m_parent;
+	std::vector<uint32_t> parent(count);
+	std::vector<uint32_t> repr(count);
+	std::vector<ucharint> rank(count, 0);
+	std::fill(zpar.begin(), zpar.end(), TREE_UNSET);
+	std::vector<uint32_t> rowindex(count);
+	for (ulongint r=0; r+1<m_rowstart.size(); r++) {
+		std::fill(rowindex.begin() + m_rowstart[r], rowindex.begin() + m_rowstart[r+1], r);
+	}
+	uint32_t neighbors[8];
+	for (ulongint i=0; i<count; i++) {
+		uint32_t p = order[i];
+		parent[p] = p;
+		zpar[p] = p;
+		repr[p] = p;
+		uint32_t zp = p;
+		ulongint r = rowindex[p];
+		uint32_t col = m_col[p];
+
+		// Neighbors in the same row are adjacent in storage, and neighbors
+		// in the rows above and below are found with one search each:
+		int ncount = 0;
+		if ((p > m_rowstart[r]) && (m_col[p-1] + 1 == col)) {
+			neighbors[ncount++] = p - 1;
+		}
+		if ((p + 1 < m_rowstart[r+1]) && (m_col[p+1] == col + 1)) {
+			neighbors[ncount++] = p + 1;
+		}
+		for (int dr=-1; dr<=1; dr+=2) {
+			if ((dr < 0) && (r == 0)) {
+				continue;
+			}
+			if ((dr > 0) && (r + 2 >= m_rowstart.size())) {
+				continue;
+			}
+			ulongint last = m_rowstart[r+dr+1];
+			ulongint n = findColumn(r + dr, col > 0 ? col - 1 : 0,
+					m_rowstart[r+dr] + (p - m_rowstart[r]));
+			for ( ; (n < last) && (m_col[n] <= col + 1); n++) {
+				neighbors[ncount++] = n;
+			}
+		}
+
+		for (int j=0; j<ncount; j++) {
+			uint32_t n = neighbors[j];
+			if (zpar[n] == TREE_UNSET) {
+				continue;
+			}
+			uint32_t zn = findRoot(n);
+			if (zn == zp) {
+				continue;
+			}
+			parent[repr[zn]] = p;
+			if (rank[zp] < rank[zn]) {
+				std::swap(zp, zn);
+			} else if (rank[zp] == rank[zn]) {
+				rank[zp]++;
+			}
+			zpar[zn] = zp;
+			repr[zp] = p;
+		}
+	}
+
+	// Point each pixel to the canonical pixel of its level (the last
+	// pixel of the level to be added, which is the node for the region):
+	for (ulongint i=count; i>0; i--) {
+		uint32_t p = order[i-1];
+		uint32_t q = parent[p];
+		if (m_value[parent[q]] == m_value[q]) {
+			parent[p] = parent[q];
+		}
+	}
+
+	// Number the nodes (children before their parents):
+	std::vector<uint32_t>& nodeindex = zpar;
+	for (ulongint i=0; i<count; i++) {
+		uint32_t p = order[i];
+		if ((parent[p] == p) || (m_value[parent[p]] != m_value[p])) {
+			nodeindex[p] = m_nodes.size();
+			ComponentInfo node;
+			node.level  = m_value[p];
+			node.area   = 0;
+			node.minrow = TREE_UNSET;
+			node.maxrow = 0;
+			node.mincol = TREE_UNSET;
+			node.maxcol = 0;
+			node.sumrow = 0.0;
+			node.sumcol = 0.0;
+			m_nodes.push_back(node);
+		} else {
+			nodeindex[p] = TREE_UNSET;
+		}
+	}
+
+	// Add the pixels to their nodes:
+	m_nodeparent.resize(m_nodes.size());
+	for (ulongint r=0; r+1<m_rowstart.size(); r++) {
+		for (ulongint p=m_rowstart[r]; p<m_rowstart[r+1]; p++) {
+			uint32_t index = nodeindex[p];
+			if (index == TREE_UNSET) {
+				index = nodeindex[parent[p]];
+			} else if (parent[p] == p) {
+				m_nodeparent[index] = -1;
+			} else {
+				m_nodeparent[index] = nodeindex[parent[p]];
+			}
+			ComponentInfo& node = m_nodes[index];
+			ulongint row = r + m_startrow;
+			node.area++;
+			node.minrow = std::min(node.minrow, row);
+			node.maxrow = std::max(node.maxrow, row);
+			node.mincol = std::min(node.mincol, (ulongint)m_col[p]);
+			node.maxcol = std::max(node.maxcol, (ulongint)m_col[p]);
+			node.sumrow += row;
+			node.sumcol += m_col[p];
+		}
+	}
+
+	// Include the regions of the child nodes in their parents:
+	for (ulongint i=0; i<m_nodes.size(); i++) {
+		if (m_nodeparent[i] < 0) {
+			continue;
+		}
+		ComponentInfo& node = m_nodes[i];
+		ComponentInfo& pnode = m_nodes[m_nodeparent[i]];
+		pnode.area  += node.area;
+		pnode.minrow = std::min(pnode.minrow, node.minrow);
+		pnode.maxrow = std::max(pnode.maxrow, node.maxrow);
+		pnode.mincol = std::min(pnode.mincol, node.mincol);
+		pnode.maxcol = std::max(pnode.maxcol, node.maxcol);
+		pnode.sumrow += node.sumrow;
+		pnode.sumcol += node.sumcol;
+	}
+
+	m_parent.swap(parent);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::getComponents -- Return the regions which would be found
+//     at the given threshold (pixels at or above the threshold), which
+//     have more than minarea pixels.
+//     default value: minarea = 0
+//
+
+void ComponentTree::getComponents(std::vector<ComponentInfo>& output,
+		int threshold, ulongint minarea) {
+	output.clear();
+	for (ulongint i=0; i<m_nodes.size(); i++) {
+		if (m_nodes[i].level < threshold) {
+			continue;
+		}
+		int parentlevel = m_nodeparent[i] < 0 ? -1 : m_nodes[m_nodeparent[i]].level;
+		if (parentlevel >= threshold) {
+			continue;
+		}
+		if (m_nodes[i].area > minarea) {
+			output.push_back(m_nodes[i]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::getThresholdCounts -- Return the number of regions with
+//     more than minarea pixels, and their total area, for each threshold
+//     from 0 to 255.  Thresholds below the minimum level of the tree only
+//     count the regions at the minimum level.
+//
+
+void ComponentTree::getThresholdCounts(std::vector<ulongint>& counts,
+		std::vector<ulongint>& areas, ulongint minarea) {
+	// Each node is the region for the thresholds above the level of its
+	// parent up to its own level.  Accumulate the differences between
+	// adjacent thresholds and then sum them:
+	std::vector<longlongint> countdiff(257, 0);
+	std::vector<longlongint> areadiff(257, 0);
+	for (ulongint i=0; i<m_nodes.size(); i++) {
+		if (m_nodes[i].area <= minarea) {
+			continue;
+		}
+		int low = m_nodeparent[i] < 0 ? m_minlevel : m_nodes[m_nodeparent[i]].level + 1;
+		int high = m_nodes[i].level;
+		countdiff[low]++;
+		countdiff[high+1]--;
+		areadiff[low] += m_nodes[i].area;
+		areadiff[high+1] -= m_nodes[i].area;
+	}
+	counts.assign(256, 0);
+	areas.assign(256, 0);
+	longlongint count = 0;
+	longlongint area = 0;
+	for (int t=0; t<256; t++) {
+		count += countdiff[t];
+		area += areadiff[t];
+		if (t >= m_minlevel) {
+			counts[t] = count;
+			areas[t] = area;
+		}
+	}
+	for (int t=0; t<m_minlevel; t++) {
+		counts[t] = counts[m_minlevel];
+		areas[t] = areas[m_minlevel];
+	}
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::getPixelCount -- Return the number of pixels in the tree.
+//
+
+ulongint ComponentTree::getPixelCount(void) {
+	return m_col.size();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::getNodeCount -- Return the number of regions in the tree.
+//
+
+ulongint ComponentTree::getNodeCount(void) {
+	return m_nodes.size();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::findColumn -- Return the index of the first pixel in the
+//     given row (counting from the first row of the tree) at or after the
+//     given column.  The search starts from a guess (the same position as
+//     the current pixel in its row), since adjacent rows usually have
+//     similar pixels, and widens exponentially from it.
+//
+
+ulongint ComponentTree::findColumn(ulongint row, uint32_t col, ulongint guess) {
+	ulongint first = m_rowstart[row];
+	ulongint last  = m_rowstart[row+1];
+	if (first == last) {
+		return last;
+	}
+	guess = std::min(std::max(guess, first), last - 1);
+
+	// Find a range [low, high) containing the answer:
+	ulongint low;
+	ulongint high;
+	ulongint step = 1;
+	if (m_col[guess] < col) {
+		low = guess + 1;
+		high = low;
+		while ((high < last) && (m_col[high] < col)) {
+			low = high + 1;
+			high = std::min(last, high + step);
+			step *= 2;
+		}
+	} else {
+		high = guess;
+		low = high;
+		while ((low > first) && (m_col[low-1] >= col)) {
+			high = low - 1;
+			low = (low - first > step) ? low - step : first;
+			step *= 2;
+		}
+	}
+	return std::lower_bound(m_col.begin() + low, m_col.begin() + high, col) - m_col.begin();
+}
+
+
+
+//////////////////////////////
+//
+// ComponentTree::findRoot -- Return the union-find root of a pixel,
+//     compressing the path to it (m_parent holds the union-find links
+//     while the tree is being built).
+//
+
+uint32_t ComponentTree::findRoot(uint32_t index) {
+	std::vector<uint32_t>& zpar = m_parent;
+	while (zpar[index] != index) {
+		zpar[index] = zpar[zpar[index]];
+		index = zpar[index];
+	}
+	return index;
+}
+
+
+
+} // end rip namespace
@@ -0,0 +1,74 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 19:12:05 PDT 2026
+// Last Modified: Mon Oct 19 19:12:05 PDT 2026
+// Filename:      DuplicateInfo.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a run of duplicated rows (frames) in
+//                a roll image, such as caused by a scanner stall.
+//
+
+#include "DuplicateInfo.h"
+
+namespace rip  {
+
+
+//////////////////////////////
+//
+// DuplicateInfo::DuplicateInfo --
+//
+
+DuplicateInfo::DuplicateInfo(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// DuplicateInfo::~DuplicateInfo --
+//
+
+DuplicateInfo::~DuplicateInfo() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// DuplicateInfo::clear --
+//
+
+void DuplicateInfo::clear(void) {
+	id.clear();
+	original  = 0;
+	duplicate = 0;
+	rows      = 0;
+}
+
+
+
+//////////////////////////////
+//
+// DuplicateInfo::printAton -- print duplicate-frame information in ATON format.
+//
+
+std::ostream& DuplicateInfo::printAton(std::ostream& out) {
+	out << "@@BEGIN: DUPLICATE\n";
+	if (!id.empty()) {
+		out << "@ID:\t\t" << id << std::endl;
+	}
+	out << "@ORIGINAL_ROW:\t"  << original  << "px" << std::endl;
+	out << "@DUPLICATE_ROW:\t" << duplicate << "px" << std::endl;
+	out << "@ROWS:\t\t"        << rows      << "px" << std::endl;
+	out << "@@END: DUPLICATE\n";
+	return out;
+}
+
+
+
+} // end rip namespace
@@ -38,20 +38,21 @@ bool isPowerOfTwo(int value) {
 //
 // FFT -- Fast Fourier Transform O(N Log N)
 //   Returns the complex spectrum of the given complex input signal.
-//   Length of Block must be a power of 2.
+//   Length of Block must be a power of 2.  Returns false (with output
+//   cleared) if the length is not a power of 2.
 //
 
-void FFT(std::vector<mycomplex>& output, std::vector<mycomplex>& input) {
+bool FFT(std::vector<mycomplex>& output, std::vector<mycomplex>& input) {
    int N = input.size();
 
    if (!isPowerOfTwo(N)) {
-      std::cerr << "You can only take the FFT of a block with length being"
-           << " a power of 2.\nRequested transform length: " << N << std::endl;
-      exit(1);
+      output.clear();
+      return false;
    }
 
    output = input;
    fft_destructive(output);
+   return true;
 }
 
 
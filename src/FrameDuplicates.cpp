@@ -0,0 +1,298 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 19:12:05 PDT 2026
+// Last Modified: Mon Oct 19 19:12:05 PDT 2026
+// Filename:      FrameDuplicates.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Streaming detector for duplicated frames (runs of
+//                repeated rows) in a roll image.
+//
+// A window of frame-size rows that repeats an earlier window starts a
+// duplicate run, which is then extended a row at a time while the rows
+// keep matching the rows following the original.  Windows made of a
+// single repeated row (such as blank paper or the background outside of
+// the roll) are not used to start runs, since they are not evidence of a
+// repeated frame.
+//
+
+#include "FrameDuplicates.h"
+#include "Crc32.h"
+
+#ifdef __SSE4_2__
+	#include <nmmintrin.h>
+	#include <cstring>
+#endif
+
+namespace rip  {
+
+// hash base for the rolling window hash (the 64-bit FNV prime):
+static const ulonglongint WINDOW_HASH_BASE = 0x100000001b3ULL;
+
+
+//////////////////////////////
+//
+// FrameDuplicates::FrameDuplicates --
+//     default value: framesize = 30
+//
+
+FrameDuplicates::FrameDuplicates(ulongint framesize) {
+	m_framesize = 1;
+	setFrameSize(framesize);
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::~FrameDuplicates --
+//
+
+FrameDuplicates::~FrameDuplicates() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::clear -- Remove all rows, keeping the frame size.
+//
+
+void FrameDuplicates::clear(void) {
+	m_checksums.clear();
+	m_windows.clear();
+	m_duplicates.clear();
+	m_run.clear();
+	m_hash       = 0;
+	m_samerows   = 0;
+	m_nextwindow = 0;
+	m_inrun      = false;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::reserve -- Allocate storage for the given number of rows.
+//
+
+void FrameDuplicates::reserve(ulongint rows) {
+	m_checksums.reserve(rows);
+	m_windows.reserve(rows);
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::setFrameSize -- Set the minimum number of repeated rows
+//     which are reported as a duplicate.  This should be set before any
+//     rows are added.
+//
+
+void FrameDuplicates::setFrameSize(ulongint rows) {
+	m_framesize = rows < 1 ? 1 : rows;
+	m_highpower = 1;
+	for (ulongint i=1; i<m_framesize; i++) {
+		m_highpower *= WINDOW_HASH_BASE;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::getFrameSize --
+//
+
+ulongint FrameDuplicates::getFrameSize(void) {
+	return m_framesize;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::addRow -- Add the next row of the image.
+//
+
+void FrameDuplicates::addRow(const void* data, ulongint bytes) {
+	addRowChecksum(rowChecksum(data, bytes));
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::addRowChecksum -- Add the checksum of the next row of
+//     the image.
+//
+
+void FrameDuplicates::addRowChecksum(uint32_t checksum) {
+	ulongint row = m_checksums.size();
+	m_checksums.push_back(checksum);
+
+	if ((row > 0) && (checksum == m_checksums[row-1])) {
+		m_samerows++;
+	} else {
+		m_samerows = 1;
+	}
+
+	if (m_inrun) {
+		ulongint orow = m_run.original + (row - m_run.duplicate);
+		if (m_checksums[orow] == checksum) {
+			m_run.rows++;
+		} else {
+			closeRun();
+			m_nextwindow = row;
+		}
+	}
+
+	// Update the hash of the window ending at this row:
+	if (row >= m_framesize) {
+		m_hash -= (ulonglongint)m_checksums[row - m_framesize] * m_highpower;
+	}
+	m_hash = m_hash * WINDOW_HASH_BASE + checksum;
+	if (row + 1 < m_framesize) {
+		return;
+	}
+	if (m_samerows >= m_framesize) {
+		return;
+	}
+
+	ulongint start = row + 1 - m_framesize;
+	auto it = m_windows.find(m_hash);
+	if (it == m_windows.end()) {
+		m_windows.emplace(m_hash, start);
+		return;
+	}
+	if (m_inrun || (start < m_nextwindow)) {
+		return;
+	}
+	if (!windowsMatch(it->second, start)) {
+		// hash collision
+		return;
+	}
+
+	m_run.clear();
+	m_run.original  = it->second;
+	m_run.duplicate = start;
+	m_run.rows      = m_framesize;
+	m_inrun         = true;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::finish -- Call after the last row has been added to
+//     complete a duplicate run at the end of the image.
+//
+
+void FrameDuplicates::finish(void) {
+	if (m_inrun) {
+		closeRun();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::getRowCount -- Return the number of rows added.
+//
+
+ulongint FrameDuplicates::getRowCount(void) {
+	return m_checksums.size();
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::getRowChecksums --
+//
+
+std::vector<uint32_t>& FrameDuplicates::getRowChecksums(void) {
+	return m_checksums;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::getDuplicates -- Return the duplicate runs found, in
+//     the order of their duplicate rows.
+//
+
+std::vector<DuplicateInfo>& FrameDuplicates::getDuplicates(void) {
+	return m_duplicates;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::rowChecksum -- CRC of the bytes of a row.  This is the
+//     CRC-32C instruction when compiled for SSE4.2, otherwise the
+//     slicing-by-16 CRC-32.
+//
+
+uint32_t FrameDuplicates::rowChecksum(const void* data, ulongint bytes) {
+#ifdef __SSE4_2__
+	const unsigned char* p = (const unsigned char*)data;
+	ulonglongint crc = 0xffffffff;
+	ulonglongint value;
+	while (bytes >= 8) {
+		memcpy(&value, p, 8);
+		crc = _mm_crc32_u64(crc, value);
+		p += 8;
+		bytes -= 8;
+	}
+	while (bytes > 0) {
+		crc = _mm_crc32_u8((uint32_t)crc, *p++);
+		bytes--;
+	}
+	return ~(uint32_t)crc;
+#else
+	return crc32_16bytes(data, bytes);
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::closeRun -- Store the current duplicate run.
+//
+
+void FrameDuplicates::closeRun(void) {
+	m_duplicates.push_back(m_run);
+	m_run.clear();
+	m_inrun = false;
+}
+
+
+
+//////////////////////////////
+//
+// FrameDuplicates::windowsMatch -- True if the row checksums of the two
+//     windows starting at the given rows are the same.
+//
+
+bool FrameDuplicates::windowsMatch(ulongint first, ulongint second) {
+	for (ulongint i=0; i<m_framesize; i++) {
+		if (m_checksums[first+i] != m_checksums[second+i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+} // end rip namespace
@@ -14,6 +14,7 @@
 // http://web.cs.wpi.edu/~emmanuel/courses/cs545/S14/slides/lecture08.pdf
 
 #include <cmath>
+#include <sstream>
 
 #include "HoleInfo.h"
 
@@ -57,6 +58,9 @@ void HoleInfo::clear(void) {
 	centroid.second = 0.0;
 	entry.first     = 0;
 	entry.second    = 0;
+	imageorigin.first  = 0;
+	imageorigin.second = 0;
+	reoriented      = false;
 	m_type          = 1;
 	track           = 0;
 	perimeter       = 0.0;
@@ -70,6 +74,54 @@ void HoleInfo::clear(void) {
 	snakebite       = false;
 	offtime         = 0;
 	midikey         = -1;
+	idkey           = 0;
+	idnumber        = 0;
+	reason          = HOLE_REASON_NONE;
+	id.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HoleInfo::getId -- Return the identifier for the hole.  Music hole
+//    identifiers are only stored as a key and note number, and the
+//    string is generated here when needed.
+//
+
+std::string HoleInfo::getId(void) {
+	if (!id.empty()) {
+		return id;
+	}
+	if (idnumber == 0) {
+		return "";
+	}
+	std::stringstream stream;
+	stream << "K" << idkey << "_N" << idnumber;
+	return stream.str();
+}
+
+
+
+//////////////////////////////
+//
+// HoleInfo::getReason -- Return the reason for being a bad hole, or
+//    an empty string if there is no reason.
+//
+
+const char* HoleInfo::getReason(void) {
+	switch (reason) {
+		case HOLE_REASON_SMALL:         return "small";
+		case HOLE_REASON_UNCENTERED:    return "uncentered";
+		case HOLE_REASON_STRANGE:       return "strange";
+		case HOLE_REASON_BASS_MARGIN:   return "bass margin";
+		case HOLE_REASON_TREBLE_MARGIN: return "treble margin";
+		case HOLE_REASON_WIDE:          return "wide";
+		case HOLE_REASON_ASPECT:        return "aspect";
+		case HOLE_REASON_SKEWED:        return "skewed";
+		case HOLE_REASON_OFF_TRACKER:   return "off tracker";
+		default:                        return "";
+	}
 }
 
 
@@ -100,11 +152,16 @@ bool HoleInfo::isShifting(void) {
 
 std::ostream& HoleInfo::printAton(std::ostream& out) {
 	out << "@@BEGIN: HOLE\n";
-	if (!id.empty()) {
-		out << "@ID:\t\t" << id << std::endl;
+	std::string holeid = getId();
+	if (!holeid.empty()) {
+		out << "@ID:\t\t" << holeid << std::endl;
 	}
 	out << "@ORIGIN_ROW:\t"   << origin.first     << std::endl;
 	out << "@ORIGIN_COL:\t"   << origin.second    << std::endl;
+	if (reoriented) {
+		out << "@IMAGE_ORIGIN_ROW:\t" << imageorigin.first  << std::endl;
+		out << "@IMAGE_ORIGIN_COL:\t" << imageorigin.second << std::endl;
+	}
 	out << "@WIDTH_ROW:\t"    << width.first      << std::endl;
 	out << "@WIDTH_COL:\t"    << width.second     << std::endl;
 	out << "@CENTROID_ROW:\t" << centroid.first   << std::endl;
@@ -136,8 +193,8 @@ std::ostream& HoleInfo::printAton(std::ostream& out) {
 	// if (!isMusicHole) {
 		out << "@MAJOR_AXIS:\t"   << int(majoraxis + 0.5) << "deg" << std::endl;
 	// }
-	if (!reason.empty()) {
-		out << "@REASON:\t"  << reason << std::endl;
+	if (reason != HOLE_REASON_NONE) {
+		out << "@REASON:\t"  << getReason() << std::endl;
 	}
 	if (snakebite) {
 		out << "@SNAKEBITE:\ttrue\n";
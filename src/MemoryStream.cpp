@@ -0,0 +1,92 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 18:20:44 PDT 2026
+// Last Modified: Mon Oct 19 18:20:48 PDT 2026
+// Filename:      MemoryStream.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Seekable input stream over a caller-owned byte buffer.
+//
+
+#include "MemoryStream.h"
+
+namespace rip  {
+
+
+//////////////////////////////
+//
+// MemoryStreamBuffer::MemoryStreamBuffer -- The buffer is not copied
+//    and must remain valid for the lifetime of the stream.
+//
+
+MemoryStreamBuffer::MemoryStreamBuffer(const ucharint* data, ulonglongint size) {
+	char* start = (char*)data;
+	setg(start, start, start + size);
+}
+
+
+
+//////////////////////////////
+//
+// MemoryStreamBuffer::seekoff --
+//
+
+std::streambuf::pos_type MemoryStreamBuffer::seekoff(off_type offset,
+		std::ios_base::seekdir dir, std::ios_base::openmode which) {
+	off_type position;
+	if (dir == std::ios_base::beg) {
+		position = offset;
+	} else if (dir == std::ios_base::cur) {
+		position = (gptr() - eback()) + offset;
+	} else {
+		position = (egptr() - eback()) + offset;
+	}
+	if ((position < 0) || (position > egptr() - eback())) {
+		return pos_type(off_type(-1));
+	}
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+
+
+//////////////////////////////
+//
+// MemoryStreamBuffer::seekpos --
+//
+
+std::streambuf::pos_type MemoryStreamBuffer::seekpos(pos_type position,
+		std::ios_base::openmode which) {
+	return seekoff(off_type(position), std::ios_base::beg, which);
+}
+
+
+
+//////////////////////////////
+//
+// MemoryStream::MemoryStream --
+//
+
+MemoryStream::MemoryStream(const ucharint* data, ulonglongint size)
+		: std::istream(NULL), m_buffer(data, size) {
+	rdbuf(&m_buffer);
+}
+
+
+
+//////////////////////////////
+//
+// MemoryStream::~MemoryStream --
+//
+
+MemoryStream::~MemoryStream() {
+
+}
+
+
+} // end rip namespace
+
+
+
@@ -0,0 +1,86 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 10:12:31 PDT 2026
+// Last Modified: Mon Oct 19 10:12:35 PDT 2026
+// Filename:      MidiNoteInfo.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a MIDI note generated from piano-roll holes.
+//
+
+#include "MidiNoteInfo.h"
+
+namespace rip  {
+
+
+//////////////////////////////
+//
+// MidiNoteInfo::MidiNoteInfo --
+//
+
+MidiNoteInfo::MidiNoteInfo(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteInfo::~MidiNoteInfo --
+//
+
+MidiNoteInfo::~MidiNoteInfo() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// MidiNoteInfo::clear --
+//
+
+void MidiNoteInfo::clear(void) {
+	track      = 0;
+	channel    = 0;
+	key        = 0;
+	velocity   = 0;
+	ontick     = 0;
+	offtick    = 0;
+	endtick    = 0;
+	attack     = true;
+	expression = false;
+}
+
+
+
+//////////////////////////////
+//
+// operator<< --
+//
+
+std::ostream& operator<<(std::ostream& out, MidiNoteInfo& ni) {
+	out << "T:"    << ni.track;
+	out << "\tC:"  << ni.channel;
+	out << "\tK:"  << ni.key;
+	out << "\tV:"  << ni.velocity;
+	out << "\tOn:" << ni.ontick;
+	out << "\tOff:"<< ni.offtick;
+	out << "\tEnd:"<< ni.endtick;
+	if (ni.attack) {
+		out << "\tATTACK";
+	}
+	if (ni.expression) {
+		out << "\tEXPRESSION";
+	}
+	return out;
+}
+
+
+
+} // end rip namespace
+
+
+
@@ -14,10 +14,28 @@
 #include "HoleInfo.h"
 #include "ShiftInfo.h"
 #include "CheckSum.h"
+#include "Crc32.h"
+#include "FrameDuplicates.h"
 
 #include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <string>
 #include <cmath>
+#include <cstring>
+
+// STRAIGHTEN_BLOCK_BYTES: size of the blocks of rows which are read,
+// shifted and written when straightening an image.
+#define STRAIGHTEN_BLOCK_BYTES (32 * 1024 * 1024)
+
+// SWEEP_MEMORY_LIMIT: largest amount of memory which the component tree
+// for a threshold sweep may use (see analyzeThresholdSweep).
+#define SWEEP_MEMORY_LIMIT (4ULL * 1024 * 1024 * 1024)
+
+// SEGMENT_MAX_OVERLAP: largest number of rows which are searched for the
+// overlap between adjacent segments of a roll image.
+#define SEGMENT_MAX_OVERLAP 4096
 
 using namespace std;
 
@@ -63,11 +81,39 @@ void RollImage::clear(void) {
 	m_dustscore                 = -1.0;
 	m_dustscorebass             = -1.0;
 	m_dustscoretreble           = -1.0;
+	m_dustscorebasserror        = 0.0;
+	m_dustscoretrebleerror      = 0.0;
+	m_dustSampleStep            = 1;
 	m_averageHoleWidth          = -1.0;
 	m_isMonochrome              = false;
 	m_useRewindHoleCorrection   = true;
 	m_emulateAcceleration       = false;
 	m_leadersAreMissing         = false;
+	m_reversedRows              = false;
+	m_mirroredCols              = false;
+	m_threshold16               = -1;
+	m_autoThreshold             = false;
+	m_otsuThreshold             = false;
+	m_sweepMin                  = 0;
+	m_sweepMax                  = -1;
+	m_sweepHoles.clear();
+	m_sweepArea.clear();
+	m_sweepDust.clear();
+	segments.clear();
+	duplicates.clear();
+	m_duplicateMode             = DUPLICATES_IGNORE;
+	m_leanMemory                = false;
+	m_channelMD5.clear();
+	m_startRow                  = 0;
+	m_endRow                    = 0;
+	m_leaderOnly                = false;
+	m_rowRange                  = false;
+	m_embedMidiFiles            = true;
+	m_summary.clear();
+	m_stepNames.clear();
+	m_stepTimes.clear();
+	m_status                    = ROLL_OK;
+	m_statusMessage.clear();
 }
 
 
@@ -78,29 +124,19 @@ void RollImage::clear(void) {
 //
 
 RollImage::~RollImage(void) {
-	for (ulongint i=0; i<holes.size(); i++) {
-		delete holes[i];
-	}
+	// Holes, tears and shifts are owned by the block pools.
 	holes.resize(0);
-	for (ulongint i=0; i<antidust.size(); i++) {
-		delete antidust[i];
-	}
+	badHoles.resize(0);
 	antidust.resize(0);
+	trackerArray.resize(0);
+	m_holePool.release();
 
-	for (ulongint i=0; i<bassTears.size(); i++) {
-		delete bassTears[i];
-	}
 	bassTears.resize(0);
-
-	for (ulongint i=0; i<trebleTears.size(); i++) {
-		delete trebleTears[i];
-	}
 	trebleTears.resize(0);
+	m_tearPool.release();
 
-	for (ulongint i=0; i<shifts.size(); i++) {
-		delete shifts[i];
-	}
 	shifts.resize(0);
+	m_shiftPool.release();
 
 	close();
 }
@@ -171,6 +207,283 @@ void RollImage::setMissingLeaders(bool value) {
 
 
 
+//////////////////////////////
+//
+// RollImage::setColumnMirror -- The image is mirrored left to right (such as
+//   when scanned from the back of the roll), so analyze the columns in
+//   reverse order.  This must be set before loadGreenChannel().
+//
+
+void RollImage::setColumnMirror(bool value) {
+	m_mirroredCols = value;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::isReversed -- True if the leader was found at the bottom of
+//   the image, so the rows are analyzed in reverse order.
+//
+
+bool RollImage::isReversed(void) {
+	return m_reversedRows;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::isMirrored -- True if the columns are analyzed in reverse
+//   order (see setColumnMirror).
+//
+
+bool RollImage::isMirrored(void) {
+	return m_mirroredCols;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getImageRow -- Convert a row in the roll (analysis) frame into
+//   a row of the input image.
+//
+
+ulongint RollImage::getImageRow(ulongint row) {
+	ulongint output = m_reversedRows ? getRows() - 1 - row : row;
+	if (m_duplicateMode == DUPLICATES_DROP) {
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			if (output < duplicates[i].duplicate) {
+				break;
+			}
+			output += duplicates[i].rows;
+		}
+	}
+	if (m_rowRange) {
+		output += m_startRow;
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getImageCol -- Convert a column in the roll (analysis) frame
+//   into a column of the input image.
+//
+
+ulongint RollImage::getImageCol(ulongint col) {
+	return m_mirroredCols ? getCols() - 1 - col : col;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setThreshold16 -- Set the paper/hole brightness boundary for
+//   16-bit images at full precision (0-65535), or -1 to use the 8-bit
+//   threshold given to loadGreenChannel().  Ignored for 8-bit images.
+//
+
+void RollImage::setThreshold16(int value) {
+	m_threshold16 = value > 65535 ? 65535 : value;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setAutoThreshold -- Choose the paper/hole brightness threshold
+//   in loadGreenChannel() from the histogram of the green channel (between
+//   the paper and backlight brightness by Otsu's method), rather than using
+//   the threshold given to loadGreenChannel().  Not used for 16-bit images
+//   with a full-precision threshold (see setThreshold16).
+//
+
+void RollImage::setAutoThreshold(bool value) {
+	m_autoThreshold = value;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setDuplicateFrames -- Check for duplicated frames (runs of
+//   repeated rows caused by the scanner stalling) while loading the image
+//   in loadGreenChannel().  DUPLICATES_MARK lists them in the analysis,
+//   and DUPLICATES_DROP also removes the repeated rows before analysis so
+//   that they do not lengthen the notes in the MIDI files.  Hole positions
+//   are then given for the image without the repeated rows, with
+//   IMAGE_ORIGIN_ROW giving the row in the input image.
+//
+
+void RollImage::setDuplicateFrames(DuplicateMode mode) {
+	m_duplicateMode = mode;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setLeanMemory -- Do not keep the monochrome (green channel)
+//   image after loadGreenChannel() has thresholded it into pixelType, which
+//   halves the memory needed for the analysis.  The image is read, hashed
+//   for CHANNEL_MD5 and thresholded in blocks of rows, so the full
+//   monochrome image is never stored.  Segmented images, automatic
+//   thresholds and duplicate-frame checks need the whole image, so in those
+//   cases it is loaded and then freed.  The channel checksum is the same
+//   as without lean memory (calculated in the row and column order of the
+//   input image), and analyzeThresholdSweep() is not available.
+//
+
+void RollImage::setLeanMemory(bool value) {
+	m_leanMemory = value;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setRowRange -- Only load and analyze the rows of the input
+//   image from startrow up to (but not including) endrow, for a quick look
+//   at part of a long roll.  An endrow of 0 is the end of the image.  The
+//   range is analyzed as if it were the whole image, so rows in the
+//   analysis are counted from startrow, with IMAGE_ORIGIN_ROW giving the
+//   row of a hole in the input image.  A range that does not start at
+//   row 0 is analyzed without searching for the leader (as with
+//   setMissingLeaders), unless setLeaderOnly() is also used.  Ranges
+//   shorter than twice the image width (plus the leader search region
+//   when searching for the leader) are rejected when loading the image.
+//   This must be set before loadGreenChannel(), and is not used for
+//   segmented images.
+//
+
+void RollImage::setRowRange(ulongint startrow, ulongint endrow) {
+	m_startRow = startrow;
+	m_endRow   = endrow;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setLeaderOnly -- Only load and analyze the start of the roll
+//   image: the region searched for the leader boundary plus a square
+//   region of the music after it (needed to find the orientation of the
+//   roll).  The leader must be at the top of the image (or at the top of
+//   the range given to setRowRange).
+//
+
+void RollImage::setLeaderOnly(bool value) {
+	m_leaderOnly = value;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::hasRowRange -- True if only part of the input image was
+//   loaded by loadGreenChannel() (see setRowRange and setLeaderOnly).
+//
+
+bool RollImage::hasRowRange(void) {
+	return m_rowRange;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::selectRowRange -- Limit the requested row range to the input
+//   image before loading it.  Returns false if the whole image is used.
+//   Throws an exception if the range is outside of the image or too short
+//   to analyze.
+//
+
+bool RollImage::selectRowRange(void) {
+	ulongint rows = getRows();
+	ulongint endrow = (m_endRow > 0) ? std::min(m_endRow, rows) : rows;
+	if (m_leaderOnly) {
+		endrow = std::min(endrow, m_startRow + 4096 * 4 + 2 * (ulongint)getCols());
+	}
+	if (m_startRow >= endrow) {
+		throw std::runtime_error("Row range " + std::to_string(m_startRow) + "-"
+				+ std::to_string(endrow) + " is outside of the image");
+	}
+	m_endRow = endrow;
+	m_rowRange = (m_startRow > 0) || (endrow < rows);
+	if (!m_rowRange) {
+		return false;
+	}
+	if ((m_startRow > 0) && !m_leaderOnly) {
+		// The leader is at the start of the roll, so a range that starts
+		// later in the image has no leader to search for.
+		m_leadersAreMissing = true;
+	}
+	// The orientation of the roll is checked with square regions at the
+	// top and bottom of the image, and the leader is searched for in the
+	// first 4096*4 rows:
+	ulongint minrows = 2 * (ulongint)getCols();
+	if (!m_leadersAreMissing) {
+		minrows += 4096 * 4;
+	}
+	if (endrow - m_startRow < minrows) {
+		throw std::runtime_error("Row range " + std::to_string(m_startRow) + "-"
+				+ std::to_string(endrow - 1) + " is too short: at least "
+				+ std::to_string(minrows) + " rows are needed"
+				+ (m_leadersAreMissing ? "" : " to find the leader (or use -n)"));
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getGreenHistogram -- Count the green channel values of the
+//   loaded image.  If pixtype is not negative, only pixels of that type
+//   (such as PIX_PAPER or PIX_MARGIN) are counted, which is useful to
+//   check the paper/hole threshold.  The rows are split between threads
+//   (0 = one for each processor).
+//   default value: pixtype = -1
+//   default value: threads = 0
+//
+
+void RollImage::getGreenHistogram(ChannelHistogram& histogram, int pixtype, int threads) {
+	histogram.setChannelCount(1);
+	ulongint rows = std::min(monochrome.size(), (ulongint)getRows());
+	if ((pixtype >= 0) && (pixelType.size() < rows)) {
+		return;
+	}
+	threads = ChannelHistogram::getThreadCount(threads, rows);
+	std::vector<ChannelHistogram> partial(threads, ChannelHistogram(1));
+	std::vector<std::thread> workers;
+	for (int t=0; t<threads; t++) {
+		ulongint startrow = rows * t / threads;
+		ulongint endrow   = rows * (t + 1) / threads;
+		workers.emplace_back([this, &partial, t, startrow, endrow, pixtype]() {
+			for (ulongint r=startrow; r<endrow; r++) {
+				if (pixtype < 0) {
+					partial[t].addValues(monochrome[r].data(), monochrome[r].size());
+				} else {
+					partial[t].addValues(monochrome[r].data(), pixelType[r].data(),
+							monochrome[r].size(), pixtype);
+				}
+			}
+		});
+	}
+	for (ulongint t=0; t<workers.size(); t++) {
+		workers[t].join();
+	}
+	for (int t=0; t<threads; t++) {
+		histogram.merge(partial[t]);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // RollImage::loadGreenChannel -- Load the green channel of the input image
@@ -179,12 +492,80 @@ void RollImage::setMissingLeaders(bool value) {
 
 void RollImage::loadGreenChannel(int threshold) {
 	setThreshold(threshold);
+
+	// For 16-bit images, the paper/non-paper mask can be calculated
+	// from the full sample values while reading:
+	bool fullprecision = (m_threshold16 >= 0) && (getBitsPerSample() == 16);
+	std::vector<std::vector<ucharint>>* mask = fullprecision ? &pixelType : NULL;
+	m_channelMD5.clear();
+	m_otsuThreshold = false;
+	m_rowRange = segments.empty() && selectRowRange();
+	if (m_leanMemory && segments.empty() && !m_autoThreshold &&
+			(m_duplicateMode == DUPLICATES_IGNORE)) {
+		m_reversedRows = false;
+		loadGreenChannelRows(fullprecision);
+		if (fullprecision) {
+			setThreshold(m_threshold16 >> 8);
+		}
+		return;
+	}
+	if (!segments.empty()) {
+		loadSegmentChannels(mask);
+	} else if (m_rowRange) {
+		int channel = (m_isMonochrome || isMonochrome()) ? 0 : 1;
+		readImageChannel(monochrome, channel, mask, (ushortint)m_threshold16,
+				m_startRow, m_endRow);
+		setRows(m_endRow - m_startRow);
+	} else if (!m_isMonochrome) {
+		this->getImageGreenChannel(monochrome, mask, (ushortint)m_threshold16);
+        } else {
+		this->getImageChannel(monochrome, mask, (ushortint)m_threshold16);
+	}
+	// The checksum is of the channel as stored in the image, before any
+	// rows are dropped, reversed or mirrored:
+	CheckSum checksum;
+	m_channelMD5 = checksum.getMD5Sum(monochrome);
+	if (m_duplicateMode != DUPLICATES_IGNORE) {
+		findDuplicateFrames(mask);
+	}
 	ulongint rows = getRows();
 	ulongint cols = getCols();
-	if (!m_isMonochrome) {
-		this->getImageGreenChannel(monochrome);
-        } else {
-		this->getImageChannel(monochrome);
+	m_reversedRows = false;
+	if (m_mirroredCols) {
+		for (ulongint r=0; r<rows; r++) {
+			std::reverse(monochrome[r].begin(), monochrome[r].end());
+			if (fullprecision) {
+				std::reverse(pixelType[r].begin(), pixelType[r].end());
+			}
+		}
+	}
+	if (fullprecision) {
+		// The mask values 1 and 0 are PIX_NONPAPER and PIX_PAPER.
+		setThreshold(m_threshold16 >> 8);
+		if (m_leanMemory) {
+			releaseGreenChannel(false);
+		}
+		return;
+	}
+	if (m_autoThreshold) {
+		ChannelHistogram histogram;
+		getGreenHistogram(histogram);
+		int value = histogram.getOtsuThreshold();
+		if (value > 0) {
+			setThreshold(value);
+			m_otsuThreshold = true;
+		} else if (m_warning) {
+			std::cerr << "Warning: no automatic threshold for this image, using "
+			          << getThreshold() << std::endl;
+		}
+		if (m_debug) {
+			std::cerr << "AUTOMATIC THRESHOLD: " << getThreshold() << std::endl;
+		}
+	}
+
+	if (m_leanMemory) {
+		releaseGreenChannel(true);
+		return;
 	}
 	pixelType.resize(rows);
 	for (ulongint r=0; r<rows; r++) {
@@ -201,6 +582,90 @@ void RollImage::loadGreenChannel(int threshold) {
 
 
 
+//////////////////////////////
+//
+// RollImage::loadGreenChannelRows -- Read the green channel in blocks of
+//   rows, thresholding each block into pixelType and adding it to the
+//   channel checksum, without storing the monochrome image (see
+//   setLeanMemory).  For 16-bit images with a full-precision threshold,
+//   the paper/non-paper mask is calculated while reading.  Only the rows
+//   from m_startRow to m_endRow are read (see selectRowRange).
+//
+
+void RollImage::loadGreenChannelRows(bool fullprecision) {
+	ulongint rows = m_endRow - m_startRow;
+	ulongint cols = getCols();
+	int channel = (m_isMonochrome || isMonochrome()) ? 0 : 1;
+	const ulongint blocksize = 256;
+	std::vector<std::vector<ucharint>> block;
+	std::vector<std::vector<ucharint>> blockmask;
+	CheckSum checksum;
+	checksum.startMD5Sum();
+
+	monochrome.clear();
+	pixelType.resize(rows);
+	for (ulongint startrow=0; startrow<rows; startrow+=blocksize) {
+		ulongint endrow = std::min(rows, startrow + blocksize);
+		readImageChannel(block, channel, fullprecision ? &blockmask : NULL,
+				(ushortint)m_threshold16, m_startRow + startrow, m_startRow + endrow);
+		for (ulongint i=0; i<block.size(); i++) {
+			ulongint r = startrow + i;
+			checksum.updateMD5Sum(block[i].data(), block[i].size());
+			if (m_mirroredCols) {
+				std::reverse(block[i].begin(), block[i].end());
+			}
+			if (fullprecision) {
+				if (m_mirroredCols) {
+					std::reverse(blockmask[i].begin(), blockmask[i].end());
+				}
+				pixelType[r] = std::move(blockmask[i]);
+				continue;
+			}
+			pixelType[r].resize(cols);
+			for (ulongint c=0; c<cols; c++) {
+				if (aboveThreshold(block[i][c], getThreshold())) {
+					pixelType[r][c] = PIX_NONPAPER;
+				} else {
+					pixelType[r][c] = PIX_PAPER;
+				}
+			}
+		}
+	}
+	m_channelMD5 = checksum.finishMD5Sum();
+	setRows(rows);
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::releaseGreenChannel -- Free the monochrome image a row at a
+//   time (see setLeanMemory).  If threshold is true, each row is
+//   thresholded in place and becomes the row of pixelType, so that the two
+//   images are not both in memory.
+//
+
+void RollImage::releaseGreenChannel(bool threshold) {
+	ulongint rows = monochrome.size();
+	if (threshold) {
+		pixelType.resize(rows);
+	}
+	for (ulongint r=0; r<rows; r++) {
+		std::vector<ucharint>& row = monochrome[r];
+		if (threshold) {
+			for (ulongint c=0; c<row.size(); c++) {
+				row[c] = aboveThreshold(row[c], getThreshold()) ? PIX_NONPAPER : PIX_PAPER;
+			}
+			pixelType[r] = std::move(row);
+		} else {
+			std::vector<ucharint>().swap(row);
+		}
+	}
+	std::vector<std::vector<ucharint>>().swap(monochrome);
+}
+
+
+
 //////////////////////////////
 //
 // RollImage::analyze -- Analyze the loaded image to detect holes and
@@ -211,56 +676,72 @@ void RollImage::analyze(void) {
 #ifndef DONOTUSEFFT
 	start_time = std::chrono::system_clock::now();
 #endif
+	m_summary.clear();
+	m_stepNames.clear();
+	m_stepTimes.clear();
+	m_status = ROLL_OK;
+	m_statusMessage.clear();
 
-	if (m_debug) { cerr << "STEP 1: analyzeBasicMargins" << endl; }
+	beginAnalysisStep(1, "analyzeBasicMargins");
 	analyzeBasicMargins();
-	if (m_debug) { cerr << "STEP 2: analyzeLeaders" << endl; }
+	beginAnalysisStep(2, "analyzeLeaders");
 	analyzeLeaders();
-	if (m_debug) { cerr << "STEP 3: analyzeAdvancedMargins" << endl; }
+	if (m_status != ROLL_OK) {
+		endAnalysisStep();
+		return;
+	}
+	beginAnalysisStep(3, "analyzeAdvancedMargins");
 	analyzeAdvancedMargins();
-	if (m_debug) { cerr << "STEP 4: generateDriftCorrection" << endl; }
+	beginAnalysisStep(4, "generateDriftCorrection");
 	generateDriftCorrection(0.01);
-	if (m_debug) { cerr << "STEP 5: analyzeHoles" << endl; }
+	beginAnalysisStep(5, "analyzeHoles");
 	analyzeHoles();
-	if (m_debug) { cerr << "STEP 6: analyzeTears" << endl; }
+	beginAnalysisStep(6, "analyzeTears");
 	analyzeTears();
-	if (m_debug) { cerr << "STEP 7: analyzeShifts" << endl; }
+	beginAnalysisStep(7, "analyzeShifts");
 	analyzeShifts();
-	if (m_debug) { cerr << "STEP 8: generateDriftCorrection" << endl; }
+	beginAnalysisStep(8, "generateDriftCorrection");
 	generateDriftCorrection(0.01);
-	if (m_debug) { cerr << "STEP 9: calculateHoleDescriptors" << endl; }
+	beginAnalysisStep(9, "calculateHoleDescriptors");
 	calculateHoleDescriptors();
-	if (m_debug) { cerr << "STEP 10: invalidateSkewedHoles" << endl; }
+	beginAnalysisStep(10, "invalidateSkewedHoles");
 	invalidateSkewedHoles();
-	if (m_debug) { cerr << "STEP 11: markPosteriorLeader" << endl; }
+	beginAnalysisStep(11, "markPosteriorLeader");
 	markPosteriorLeader();
-	if (m_debug) { cerr << "STEP 12: analyzeTrackerBarSpacing" << endl; }
+	beginAnalysisStep(12, "analyzeTrackerBarSpacing");
 	storeCorrectedCentroidHistogram();
 	analyzeRawRowPositions();
 	analyzeTrackerBarSpacing();
-	if (m_debug) { cerr << "STEP 13: analyzeTrackerBarPositions" << endl; }
+	if (m_status != ROLL_OK) {
+		endAnalysisStep();
+		return;
+	}
+	beginAnalysisStep(13, "analyzeTrackerBarPositions");
 	// analyzeTrackerBarPositions();
 	calculateTrackerSpacings2();
-	if (m_debug) { cerr << "STEP 14: analyzeHorizontalHolePosition" << endl; }
+	analyzeTrackerSections();
+	beginAnalysisStep(14, "analyzeHorizontalHolePosition");
 	analyzeHorizontalHolePosition();
-	if (m_debug) { cerr << "STEP 15: analyzeMidiKeyMapping" << endl; }
+	beginAnalysisStep(15, "analyzeMidiKeyMapping");
 	analyzeMidiKeyMapping();
-	if (m_debug) { cerr << "STEP 16: invalidateEdgeHoles" << endl; }
+	beginAnalysisStep(16, "invalidateEdgeHoles");
 	invalidateEdgeHoles();
-	if (m_debug) { cerr << "STEP 17: invalidateOffTrackerHoles" << endl; }
+	beginAnalysisStep(17, "invalidateOffTrackerHoles");
 	invalidateOffTrackerHoles();
-	if (m_debug) { cerr << "STEP 18: recalculateFirstMusicHole" << endl; }
+	beginAnalysisStep(18, "recalculateFirstMusicHole");
 	recalculateFirstMusicHole();
-	if (m_debug) { cerr << "STEP 19: addDriftInfoToHoles" << endl; }
+	beginAnalysisStep(19, "addDriftInfoToHoles");
 	addDriftInfoToHoles();
-	if (m_debug) { cerr << "STEP 20: addAntidustToBadHoles" << endl; }
+	beginAnalysisStep(20, "addAntidustToBadHoles");
 	addAntidustToBadHoles(50);
-	if (m_debug) { cerr << "STEP 21: assignMusicHoleIds" << endl; }
+	beginAnalysisStep(21, "assignMusicHoleIds");
 	assignMusicHoleIds();
-	if (m_debug) { cerr << "STEP 22: groupHoles" << endl; }
+	beginAnalysisStep(22, "groupHoles");
 	groupHoles();
-	if (m_debug) { cerr << "STEP 23: analyzeSnakeBites" << endl; }
+	beginAnalysisStep(23, "analyzeSnakeBites");
 	analyzeSnakeBites();
+	addImageOriginsToHoles();
+	endAnalysisStep();
 	if (m_debug) { cerr << "STEP 24: FINSHED WITH ANALYSIS!" << endl; }
 
 #ifndef DONOTUSEFFT
@@ -270,6 +751,575 @@ void RollImage::analyze(void) {
 
 
 
+//////////////////////////////
+//
+// RollImage::analyzeQuality -- Analyze only what is needed for
+//   printQualityReport() (the margins, leader, shifts and dust), as a fast
+//   check of incoming scans.  The holes are not extracted, so the rows of
+//   the music are estimated from the non-paper pixels between the hard
+//   margins (see estimateMusicRows), and no MIDI data is generated.
+//
+
+void RollImage::analyzeQuality(void) {
+#ifndef DONOTUSEFFT
+	start_time = std::chrono::system_clock::now();
+#endif
+	m_summary.clear();
+	m_stepNames.clear();
+	m_stepTimes.clear();
+	m_status = ROLL_OK;
+	m_statusMessage.clear();
+
+	beginAnalysisStep(1, "analyzeBasicMargins");
+	analyzeBasicMargins();
+	beginAnalysisStep(2, "analyzeLeaders");
+	analyzeLeaders();
+	if (m_status != ROLL_OK) {
+		endAnalysisStep();
+		return;
+	}
+	beginAnalysisStep(3, "analyzeAdvancedMargins");
+	analyzeAdvancedMargins();
+	beginAnalysisStep(4, "estimateMusicRows");
+	estimateMusicRows();
+	beginAnalysisStep(5, "analyzeShifts");
+	analyzeShifts();
+	endAnalysisStep();
+
+#ifndef DONOTUSEFFT
+	stop_time = std::chrono::system_clock::now();
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::estimateMusicRows -- Set the first and last rows of the music
+//   without extracting the holes: the music starts at the first run of
+//   rows after the leader that all have non-paper pixels between the hard
+//   margins, and ends at the end of the last such run.  Pixels next to the
+//   edge of the paper are skipped, and a run must be at least 10 rows long
+//   and have as many pixels as the smallest music holes (300), so that
+//   bright specks and edge damage are not counted as holes.  If no music
+//   is found, all rows after the leader are used.
+//
+
+void RollImage::estimateMusicRows(void) {
+	int   startcol = getHardMarginLeftIndex()+1;
+	int   endcol   = getHardMarginRightIndex();
+	ulongint startrow = getLeaderIndex();
+	ulongint endrow   = getRows();
+	const ulongint minrun = 10;
+	const ulongint minarea = 300;
+	const int edge = 10;
+
+	firstMusicRow = 0;
+	lastMusicRow  = 0;
+	ulongint run = 0;
+	ulongint area = 0;
+	for (ulongint r=startrow; r<endrow; r++) {
+		std::vector<ucharint>& rowdata = pixelType[r];
+		int c1 = std::max(startcol, leftMarginIndex[r] + edge);
+		int c2 = std::min(endcol, rightMarginIndex[r] - edge);
+		ulongint count = 0;
+		for (int c=c1; c<c2; c++) {
+			if (rowdata[c] == PIX_NONPAPER) {
+				count++;
+			}
+		}
+		if (count == 0) {
+			run = 0;
+			area = 0;
+			continue;
+		}
+		run++;
+		area += count;
+		if ((run < minrun) || (area < minarea)) {
+			continue;
+		}
+		if (lastMusicRow == 0) {
+			firstMusicRow = r + 1 - run;
+		}
+		lastMusicRow = r;
+	}
+
+	if (lastMusicRow == 0) {
+		firstMusicRow = startrow;
+		lastMusicRow  = endrow - 1;
+	}
+	if (m_debug) {
+		std::cerr << "ESTIMATED MUSIC ROWS: " << firstMusicRow << " to " << lastMusicRow << std::endl;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::openSegments -- Prepare a roll which was scanned in several
+//   parts for analysis as a single image.  The segments are the pages
+//   (image directories) of the given files in order, skipping reduced-size
+//   images such as thumbnails.  Rows at the start of a segment which repeat
+//   the end of the previous segment are removed when the image is loaded
+//   by loadGreenChannel(), so the segments are not stitched into a new
+//   file.  The header information (such as DPI) is taken from the first
+//   file.  All segments must have the same width and sample format.
+//
+
+bool RollImage::openSegments(const std::vector<std::string>& filenames) {
+	segments.clear();
+	if (filenames.empty()) {
+		return false;
+	}
+	if (!openMapped(filenames[0])) {
+		std::cerr << "Input filename " << filenames[0] << " cannot be opened" << std::endl;
+		return false;
+	}
+
+	for (ulongint i=0; i<filenames.size(); i++) {
+		TiffFile segment;
+		if (!segment.openMapped(filenames[i])) {
+			std::cerr << "Input filename " << filenames[i] << " cannot be opened" << std::endl;
+			segments.clear();
+			return false;
+		}
+		int pagecount = segment.getPageCount();
+		for (int j=0; j<pagecount; j++) {
+			if ((j > 0) && !segment.selectPage(j)) {
+				std::cerr << "Cannot read page " << j << " of " << filenames[i] << std::endl;
+				segments.clear();
+				return false;
+			}
+			if (segment.isReducedImage()) {
+				continue;
+			}
+			if ((segment.getCols() != getCols()) ||
+					(segment.getSamplesPerPixel() != getSamplesPerPixel()) ||
+					(segment.getBitsPerSample() != getBitsPerSample())) {
+				std::cerr << "Page " << j << " of " << filenames[i]
+				          << " does not match the size or format of the first segment" << std::endl;
+				segments.clear();
+				return false;
+			}
+			SegmentInfo info;
+			info.filename = filenames[i];
+			info.page     = j;
+			info.rows     = segment.getRows();
+			segments.push_back(info);
+		}
+	}
+
+	if (segments.empty()) {
+		std::cerr << "No full-size images found in the input files" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getSegmentCount -- Return the number of segments the image
+//   is stitched from, or 0 if the image was not opened with openSegments().
+//
+
+int RollImage::getSegmentCount(void) {
+	return (int)segments.size();
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::loadSegmentChannels -- Read the segments into the monochrome
+//   image (and the mask if not NULL), dropping the overlap between
+//   adjacent segments.  The number of image rows is then the length of
+//   the stitched image.
+//
+
+void RollImage::loadSegmentChannels(std::vector<std::vector<ucharint>>* mask) {
+	monochrome.clear();
+	if (mask) {
+		mask->clear();
+	}
+	std::vector<std::vector<ucharint>> image;
+	std::vector<std::vector<ucharint>> imagemask;
+	std::vector<std::vector<ucharint>>* pagemask = mask ? &imagemask : NULL;
+
+	for (ulongint i=0; i<segments.size(); i++) {
+		SegmentInfo& info = segments[i];
+		TiffFile segment;
+		if (!segment.openMapped(info.filename) ||
+				((info.page > 0) && !segment.selectPage(info.page))) {
+			throw std::runtime_error("Cannot read segment " + info.filename);
+		}
+		if (!m_isMonochrome) {
+			segment.getImageGreenChannel(image, pagemask, (ushortint)m_threshold16);
+		} else {
+			segment.getImageChannel(image, pagemask, (ushortint)m_threshold16);
+		}
+
+		ulongint overlap = findSegmentOverlap(monochrome, image, info.ambiguous);
+		info.startrow = monochrome.size();
+		info.overlap  = overlap;
+		if (info.ambiguous && m_warning) {
+			std::cerr << "Warning: the overlap between segment " << i
+			          << " and the previous segment is ambiguous, so no rows are removed"
+			          << std::endl;
+		}
+		info.rows     = image.size() - overlap;
+		for (ulongint r=overlap; r<image.size(); r++) {
+			monochrome.push_back(std::move(image[r]));
+			if (mask) {
+				mask->push_back(std::move(imagemask[r]));
+			}
+		}
+		if (m_debug) {
+			std::cerr << "SEGMENT " << i << ": " << info.filename << " page " << info.page
+			          << " rows " << image.size() << " overlap " << overlap << std::endl;
+		}
+	}
+
+	setRows(monochrome.size());
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::findDuplicateFrames -- Find the duplicated frames in the
+//   loaded image from the checksums of its rows, and remove them from the
+//   image (and the mask if not NULL) if requested by setDuplicateFrames().
+//
+
+void RollImage::findDuplicateFrames(std::vector<std::vector<ucharint>>* mask) {
+	FrameDuplicates detector;
+	detector.reserve(monochrome.size());
+	for (ulongint r=0; r<monochrome.size(); r++) {
+		detector.addRow(monochrome[r].data(), monochrome[r].size());
+	}
+	detector.finish();
+	duplicates = detector.getDuplicates();
+
+	if (m_debug) {
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			std::cerr << "DUPLICATE FRAME: " << duplicates[i].rows << " rows at "
+			          << duplicates[i].duplicate << " repeat row "
+			          << duplicates[i].original << std::endl;
+		}
+	}
+
+	if ((m_duplicateMode != DUPLICATES_DROP) || duplicates.empty()) {
+		return;
+	}
+
+	// The duplicate runs are sorted and do not overlap:
+	ulongint output = 0;
+	ulongint index = 0;
+	for (ulongint r=0; r<monochrome.size(); r++) {
+		if ((index < duplicates.size()) && (r >= duplicates[index].duplicate)) {
+			if (r < duplicates[index].duplicate + duplicates[index].rows) {
+				continue;
+			}
+			index++;
+		}
+		if (output != r) {
+			monochrome[output] = std::move(monochrome[r]);
+			if (mask) {
+				(*mask)[output] = std::move((*mask)[r]);
+			}
+		}
+		output++;
+	}
+	monochrome.resize(output);
+	if (mask) {
+		mask->resize(output);
+	}
+	setRows(output);
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::findSegmentOverlap -- Return the number of rows at the start
+//   of next which repeat the rows at the end of previous.  Rows are
+//   compared by CRC-32 checksums, and matches are then verified on the
+//   pixels.  Only the last SEGMENT_MAX_OVERLAP rows of previous are
+//   searched.  Overlaps made of a single repeated row (such as blank
+//   paper) are not evidence of where the segments join, so they are not
+//   used.  If no other overlap is found but such rows match, or if more
+//   than one overlap matches, ambiguous is set and 0 is returned so that
+//   no rows of the roll are dropped.
+//
+
+ulongint RollImage::findSegmentOverlap(std::vector<std::vector<ucharint>>& previous,
+		std::vector<std::vector<ucharint>>& next, bool& ambiguous) {
+	ambiguous = false;
+	ulongint maxoverlap = std::min(previous.size(), next.size());
+	maxoverlap = std::min(maxoverlap, (ulongint)SEGMENT_MAX_OVERLAP);
+	if (maxoverlap == 0) {
+		return 0;
+	}
+	ulongint start = previous.size() - maxoverlap;
+
+	std::vector<uint32_t> tail(maxoverlap);
+	std::vector<uint32_t> head(maxoverlap);
+	for (ulongint r=0; r<maxoverlap; r++) {
+		tail[r] = crc32_fast(previous[start+r].data(), previous[start+r].size());
+		head[r] = crc32_fast(next[r].data(), next[r].size());
+	}
+
+	// samerun: number of rows at the start of next which repeat its first row.
+	ulongint samerun = 1;
+	while ((samerun < maxoverlap) && (head[samerun] == head[0]) &&
+			(next[samerun] == next[0])) {
+		samerun++;
+	}
+
+	ulongint overlap = 0;
+	int matches = 0;
+	bool repeated = false;
+	for (ulongint k=maxoverlap; k>0; k--) {
+		ulongint offset = maxoverlap - k;
+		if (tail[offset] != head[0]) {
+			continue;
+		}
+		bool match = true;
+		for (ulongint r=0; r<k; r++) {
+			if (tail[offset+r] != head[r]) {
+				match = false;
+				break;
+			}
+		}
+		if (match && (k <= samerun)) {
+			// only one repeated row matches
+			repeated = true;
+			continue;
+		}
+		for (ulongint r=0; match && (r<k); r++) {
+			if (previous[start+offset+r] != next[r]) {
+				match = false;
+			}
+		}
+		if (!match) {
+			continue;
+		}
+		if (matches == 0) {
+			overlap = k;
+		}
+		matches++;
+	}
+
+	if ((matches > 1) || ((matches == 0) && repeated)) {
+		ambiguous = true;
+		return 0;
+	}
+	return overlap;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::analyzeThresholdSweep -- After analyze(), find how many holes
+//   (and how much hole area) there would be on the paper at each threshold
+//   in the given range.  The holes at all thresholds are read from one
+//   component tree of the bright pixels, so the image is not loaded or
+//   analyzed again for each threshold.  Regions must have more than 100
+//   pixels to be counted as holes (as in extractHole()); smaller regions
+//   are counted as dust.  Every paper pixel at or above minthreshold is
+//   stored in the tree, so a low minimum on a long roll needs a lot of
+//   memory: the sweep is refused (returning false) if the tree would use
+//   more than SWEEP_MEMORY_LIMIT bytes.
+//
+
+bool RollImage::analyzeThresholdSweep(int minthreshold, int maxthreshold) {
+	m_sweepHoles.clear();
+	m_sweepArea.clear();
+	m_sweepDust.clear();
+	minthreshold = std::max(1, minthreshold);
+	maxthreshold = std::min(255, maxthreshold);
+	m_sweepMin = minthreshold;
+	m_sweepMax = maxthreshold;
+	if ((minthreshold > maxthreshold) || monochrome.empty()) {
+		m_sweepMax = minthreshold - 1;
+		return true;
+	}
+
+	// Limit the regions to the paper between the soft margins:
+	ulongint rows = getRows();
+	std::vector<int> startcols(rows, 0);
+	std::vector<int> endcols(rows, 0);
+	for (ulongint r=0; r<rows; r++) {
+		startcols[r] = std::max(getHardMarginLeftIndex() + 1, leftMarginIndex[r] + 1);
+		endcols[r]   = std::min(getHardMarginRightIndex(), rightMarginIndex[r]);
+	}
+
+	ulonglongint pixels = ComponentTree::countPixels(monochrome, getLeaderIndex(),
+			rows, startcols, endcols, minthreshold);
+	ulonglongint bytes = pixels * TREE_PIXEL_BYTES;
+	ComponentTree tree;
+	if ((bytes > SWEEP_MEMORY_LIMIT) ||
+			!tree.build(monochrome, getLeaderIndex(), rows, startcols, endcols, minthreshold)) {
+		std::cerr << "Threshold sweep from " << minthreshold << " would store " << pixels
+		          << " pixels (" << bytes / (1024 * 1024) << " MB), more than the limit of "
+		          << SWEEP_MEMORY_LIMIT / (1024 * 1024) << " MB.  Use a higher minimum threshold."
+		          << std::endl;
+		m_sweepMax = minthreshold - 1;
+		return false;
+	}
+
+	ulongint minarea = 100;
+	std::vector<ulongint> counts;
+	std::vector<ulongint> areas;
+	std::vector<ulongint> allcounts;
+	std::vector<ulongint> allareas;
+	tree.getThresholdCounts(counts, areas, minarea);
+	tree.getThresholdCounts(allcounts, allareas, 0);
+	for (int t=minthreshold; t<=maxthreshold; t++) {
+		m_sweepHoles.push_back(counts[t]);
+		m_sweepArea.push_back(areas[t]);
+		m_sweepDust.push_back(allcounts[t] - counts[t]);
+	}
+	if (m_debug) {
+		std::cerr << "THRESHOLD SWEEP: " << tree.getPixelCount() << " pixels, "
+		          << tree.getNodeCount() << " regions" << std::endl;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::analyzeRoll -- Library entry point: analyze an image which
+//    has already been opened (from a file, memory or a stream) for the
+//    given roll type (see RollOptions::setRollType).  Other analysis
+//    settings, such as setMissingLeaders(), should be made beforehand.
+//    Errors are returned as a status (with a description available from
+//    getStatusMessage()) rather than ending the program.
+//    default value: threshold = 249
+//
+
+RollStatus RollImage::analyzeRoll(const std::string& rolltype, int threshold) {
+	m_status = ROLL_OK;
+	m_statusMessage.clear();
+	if ((getRows() == 0) || (getCols() == 0)) {
+		setStatus(ROLL_ERROR_OPEN, "No image is open");
+		return m_status;
+	}
+	if (!setRollType(rolltype)) {
+		setStatus(ROLL_ERROR_ROLLTYPE, "Unknown roll type: " + rolltype);
+		return m_status;
+	}
+	try {
+		loadGreenChannel(threshold);
+		analyze();
+	} catch (std::exception& e) {
+		endAnalysisStep();
+		setStatus(ROLL_ERROR_ANALYSIS, std::string("Analysis failed: ") + e.what());
+	}
+	return m_status;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getStatus -- Return the status of the last analysis.
+//
+
+RollStatus RollImage::getStatus(void) {
+	return m_status;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getStatusMessage -- Return a description of the error for the
+//    last analysis, or an empty string if there was no error.
+//
+
+std::string RollImage::getStatusMessage(void) {
+	return m_statusMessage;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setStatus -- Store an analysis error.  Only the first error
+//    is kept.
+//
+
+void RollImage::setStatus(RollStatus status, const std::string& message) {
+	if (m_status != ROLL_OK) {
+		return;
+	}
+	m_status = status;
+	m_statusMessage = message;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::beginAnalysisStep -- Print the step in debug mode and
+//    start timing it (ending the timing of any previous step).
+//
+
+void RollImage::beginAnalysisStep(int number, const std::string& name) {
+	endAnalysisStep();
+	if (m_debug) { cerr << "STEP " << number << ": " << name << endl; }
+	m_stepNames.push_back(name);
+#ifndef DONOTUSEFFT
+	m_stepStart = std::chrono::steady_clock::now();
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::endAnalysisStep -- Store the elapsed time of the current
+//    analysis step, if any.  Times are 0.0 when compiled without chrono
+//    support.
+//
+
+void RollImage::endAnalysisStep(void) {
+	if (m_stepTimes.size() >= m_stepNames.size()) {
+		return;
+	}
+	double seconds = 0.0;
+#ifndef DONOTUSEFFT
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	seconds = std::chrono::duration<double>(now - m_stepStart).count();
+#endif
+	m_stepTimes.push_back(seconds);
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getAnalysisStepTimes -- Return the names and elapsed times
+//    in seconds of the steps of the last call to analyze().  Steps which
+//    are run more than once are listed for each run.
+//
+
+void RollImage::getAnalysisStepTimes(std::vector<std::string>& names,
+		std::vector<double>& seconds) {
+	names = m_stepNames;
+	seconds = m_stepTimes;
+	names.resize(seconds.size());
+}
+
+
+
 //////////////////////////////
 //
 // RollImage::analyzeSnakeBites -- Needs to be improved since it is sensitive
@@ -409,7 +1459,7 @@ return; // disabling for now
 		double offset = fabs(newtrackpos - hi[i]->centroid.second);
 		if (offset > maxoffset) {
 			cerr << "BAD HOLE " << offset << endl;
-			hi[i]->reason = "uncentered";
+			hi[i]->reason = HOLE_REASON_UNCENTERED;
 			hi[i]->setNonHole();
 		}
 	}
@@ -511,6 +1561,8 @@ void RollImage::getInterHoleCutoff(void) {
 //
 
 void RollImage::groupHoles(void) {
+	// Note-off times change, so the MIDI event table must be rebuilt:
+	midiEvents.resize(0);
 	getInterHoleCutoff();
 	for (ulongint i=0; i<trackerArray.size(); i++) {
 		groupHoles(i);
@@ -607,6 +1659,9 @@ void RollImage::calculateHoleDescriptors(void) {
 //
 
 void RollImage::assignMidiKeyNumbersToHoles(void) {
+	// MIDI event table will need to be rebuilt with the new key numbers.
+	midiEvents.resize(0);
+
 	// Apply the current MIDI number to tracker column mappings to all holes
 	// in those columns (because we may just return this with no changes).
 	for (int i=0; i<(int)midiToTrackMapping.size(); i++) {
@@ -1087,24 +2142,28 @@ void RollImage::invalidateEdgeHoles(void) {
 	ulongint maxwidth = int(holeSeparation * getMaxHoleTrackerWidth() + 0.5);
 
 	for (ulongint i=0; i<holes.size(); i++) {
+		if (holes[i]->reason == HOLE_REASON_OFF_TRACKER) {
+			// already invalidated in analyzeHorizontalHolePosition()
+			continue;
+		}
 		if (holes[i]->track == 0) {
 			clearHole(*holes[i], PIX_ANTIDUST);
 			badHoles.push_back(holes[i]);
-			holes[i]->reason = "strange";
+			holes[i]->reason = HOLE_REASON_STRANGE;
 			continue;
 		} else if (holes[i]->track < mintrack) {
 			// out of range on bass side
 			clearHole(*holes[i], PIX_ANTIDUST);
 			holes[i]->track = 0;
 			badHoles.push_back(holes[i]);
-			holes[i]->reason = "bass margin";
+			holes[i]->reason = HOLE_REASON_BASS_MARGIN;
 			continue;
 		} else if (holes[i]->track > maxtrack) {
 			// out of range on treble side
 			clearHole(*holes[i], PIX_ANTIDUST);
 			holes[i]->track = 0;
 			badHoles.push_back(holes[i]);
-			holes[i]->reason = "treble margin";
+			holes[i]->reason = HOLE_REASON_TREBLE_MARGIN;
 			continue;
 		}
 		if (holes[i]->width.second >= maxwidth) {
@@ -1113,14 +2172,14 @@ void RollImage::invalidateEdgeHoles(void) {
 			holes[i]->track = 0;
 			holes[i]->setNonHole();
 			badHoles.push_back(holes[i]);
-			holes[i]->reason = "wide";
+			holes[i]->reason = HOLE_REASON_WIDE;
 			continue;
 		}
 		double aspect = (double)holes[i]->width.second / (double)holes[i]->width.first;
 		if (aspect > getAspectRatioThreshold()) {
 			// Hole is wider than it is long, which should never happen for a music hole.
 			clearHole(*holes[i], PIX_BADHOLE_ASPECT);
-			holes[i]->reason = "aspect";
+			holes[i]->reason = HOLE_REASON_ASPECT;
 			holes[i]->track = 0;
 			holes[i]->setNonHole();
 			badHoles.push_back(holes[i]);
@@ -1154,7 +2213,7 @@ void RollImage::invalidateSkewedHoles(void) {
 		//		<< "\t" << holes[i]->majoraxis
 		//		<< std::endl;
 		clearHole(*holes[i], PIX_BADHOLE_SKEWED);
-		holes[i]->reason = "skewed";
+		holes[i]->reason = HOLE_REASON_SKEWED;
 		badHoles.push_back(holes[i]);
 	}
 }
@@ -1191,15 +2250,32 @@ void RollImage::analyzeHorizontalHolePosition() {
 	int tcount = (getCols()+holeOffset) / holeSeparation;
 	trackerArray.resize(0);
 	trackerArray.resize(tcount);
+	double separation;
+	double offset;
+	ulongint offtracker = 0;
 	for (ulongint i=0; i<holes.size(); i++) {
 		double position = holes[i]->centroid.second;
 		double correction = driftCorrection[int(holes[i]->centroid.first+0.5)];
+		getLocalTrackerModel(holes[i]->centroid.first, separation, offset);
 		// double cpos = position + correction + holeOffset;
-		double cpos = position + correction - holeOffset;
-		int index = int(cpos / holeSeparation + 0.5);
+		double cpos = position + correction - offset;
+		int index = int(cpos / separation + 0.5);
+		if ((index < 0) || (index >= (int)trackerArray.size())) {
+			// The local tracker model places the hole beyond the ends of
+			// the tracker bar, so it cannot be a music hole.
+			clearHole(*holes[i], PIX_ANTIDUST);
+			holes[i]->track = 0;
+			holes[i]->reason = HOLE_REASON_OFF_TRACKER;
+			badHoles.push_back(holes[i]);
+			offtracker++;
+			continue;
+		}
 		trackerArray.at(index).push_back(holes.at(i));
 		holes[i]->track = index;
 	}
+	if (m_warning && (offtracker > 0)) {
+		cerr << "Warning: " << offtracker << " holes are off of the tracker bar" << endl;
+	}
 
 	trackMeaning.resize(trackerArray.size());
 	std::fill(trackMeaning.begin(), trackMeaning.end(), TRACK_UNKNOWN);
@@ -1212,102 +2288,305 @@ void RollImage::analyzeHorizontalHolePosition() {
 		} else {
 			cerr << 0;
 		}
-		cerr << "\n";
+		cerr << "\n";
+	}
+	*/
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::assignMusicHoleIds --
+//
+
+void RollImage::assignMusicHoleIds(void) {
+	vector<vector<HoleInfo*> >& ta = trackerArray;
+
+	ulongint counter;
+	ulongint key;
+	for (ulongint i=0; i<ta.size(); i++) {
+		counter = 1;
+		key = midiToTrackMapping[i];
+		for (ulongint j=0; j<ta[i].size(); j++) {
+			if (!ta[i][j]->isMusicHole()) {
+				continue;
+			}
+			ta[i][j]->idkey    = key;
+			ta[i][j]->idnumber = counter++;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::analyzeTrackerBarPositions -- Calculate the sub-pixel offset
+//    of the tracker-bar hole pattern from the drift-corrected centroid
+//    histogram.  Not currently used in analyze(), which uses
+//    calculateTrackerSpacings2() instead.
+//
+
+void RollImage::analyzeTrackerBarPositions(void) {
+	std::vector<pair<int, int> > bins;
+	getSparseCentroidHistogram(bins, correctedCentroidHistogram);
+	holeOffset = getTrackerOffset(m_trackerShiftScores, bins, holeSeparation, 0.05);
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::analyzeTrackerSections -- Estimate the tracker-bar hole
+//    separation and offset in overlapping windows along the length of the
+//    roll, so that track assignment can follow paper which is stretched
+//    or drifts out of alignment with the global tracker model over long
+//    rolls.  Each window is centered on a row listed in m_sectionRow,
+//    and getLocalTrackerModel() interpolates between the windows.  Windows
+//    with too few holes are skipped and covered by their neighbors.
+//
+
+void RollImage::analyzeTrackerSections(void) {
+	m_sectionRow.resize(0);
+	m_sectionSeparation.resize(0);
+	m_sectionOffset.resize(0);
+
+	if ((holeSeparation <= 0.0) || holes.empty()) {
+		return;
+	}
+
+	ulongint windowsize = ulongint(30.0 * getPixelsPerInch());  // 30 inches
+	ulongint hopsize    = windowsize / 2;
+	ulongint minholes   = 100;
+	ulongint startrow   = getFirstMusicHoleStart();
+	ulongint endrow     = getLastMusicHoleEnd();
+	if (endrow <= startrow) {
+		return;
+	}
+
+	// Sort the holes into hop-sized bins by row so that each window only has
+	// to visit the holes which it contains.
+	ulongint hopcount = (endrow - startrow) / hopsize + 1;
+	std::vector<std::vector<HoleInfo*> > hops(hopcount);
+	for (ulongint i=0; i<holes.size(); i++) {
+		double row = holes[i]->centroid.first;
+		if ((row < startrow) || (row > endrow)) {
+			continue;
+		}
+		hops.at(ulongint(row - startrow) / hopsize).push_back(holes[i]);
+	}
+
+	double maxdelta = holeSeparation * 0.005;
+	int    deltacount = 10;
+	std::vector<int> histogram(getCols(), 0);
+	std::vector<pair<int, int> > bins;
+	std::vector<double> scores;
+
+	for (ulongint w=0; w+1<hopcount || w==0; w++) {
+		std::fill(histogram.begin(), histogram.end(), 0);
+		ulongint holecount = 0;
+		double colsum = 0.0;
+		for (ulongint h=w; (h<=w+1) && (h<hopcount); h++) {
+			for (ulongint i=0; i<hops[h].size(); i++) {
+				HoleInfo* hi = hops[h][i];
+				double correction = driftCorrection[int(hi->centroid.first + 0.5)];
+				int position = int(hi->centroid.second + correction + 0.5);
+				if ((position < 0) || (position >= (int)histogram.size())) {
+					continue;
+				}
+				histogram[position]++;
+				colsum += position;
+				holecount++;
+			}
+		}
+		if (holecount < minholes) {
+			continue;
+		}
+		getSparseCentroidHistogram(bins, histogram);
+
+		// Search for the best separation near the global separation,
+		// preferring the global separation unless another one fits better
+		// by at least one percent.
+		double bestseparation = holeSeparation;
+		getTrackerShiftScores(scores, bins, holeSeparation, 0.1);
+		double bestscore = *std::min_element(scores.begin(), scores.end()) * 0.99;
+		for (int d=-deltacount; d<=deltacount; d++) {
+			if (d == 0) {
+				continue;
+			}
+			double separation = holeSeparation + maxdelta * d / deltacount;
+			getTrackerShiftScores(scores, bins, separation, 0.1);
+			double score = *std::min_element(scores.begin(), scores.end());
+			if (score < bestscore) {
+				bestscore = score;
+				bestseparation = separation;
+			}
+		}
+		double offset = getTrackerOffset(scores, bins, bestseparation, 0.05);
+
+		// Keep the tracker numbering consistent with the global model at the
+		// average hole column in the window.
+		double center = colsum / holecount;
+		double globalindex = (center - holeOffset) / holeSeparation;
+		double localindex  = (center - offset) / bestseparation;
+		offset += bestseparation * std::floor(localindex - globalindex + 0.5);
+
+		ulongint centerrow = startrow + w * hopsize + hopsize;
+		if (centerrow > endrow) {
+			centerrow = (startrow + endrow) / 2;
+		}
+		m_sectionRow.push_back(centerrow);
+		m_sectionSeparation.push_back(bestseparation);
+		m_sectionOffset.push_back(offset);
+	}
+
+	if (m_debug) {
+		for (ulongint i=0; i<m_sectionRow.size(); i++) {
+			cerr << "TRACKER SECTION ROW " << m_sectionRow[i]
+			     << "\tSEPARATION " << m_sectionSeparation[i]
+			     << "\tOFFSET " << m_sectionOffset[i] << endl;
+		}
 	}
-	*/
 }
 
 
 
 //////////////////////////////
 //
-// RollImage::assignMusicHoleIds --
+// RollImage::getLocalTrackerModel -- Return the tracker-bar hole separation
+//    and offset at the given row, linearly interpolated between the windows
+//    calculated in analyzeTrackerSections().  Rows outside of the analyzed
+//    windows use the nearest window, and the global holeSeparation and
+//    holeOffset are used if there are no windows.
 //
 
-void RollImage::assignMusicHoleIds(void) {
-	vector<vector<HoleInfo*> >& ta = trackerArray;
-
-	ulongint counter;
-	ulongint key;
-	for (ulongint i=0; i<ta.size(); i++) {
-		counter = 1;
-		key = midiToTrackMapping[i];
-		for (ulongint j=0; j<ta[i].size(); j++) {
-			if (!ta[i][j]->isMusicHole()) {
-				continue;
-			}
-			ta[i][j]->id = "K" + my_to_string(key) + "_N" + my_to_string(counter++);
-		}
+void RollImage::getLocalTrackerModel(double row, double& separation, double& offset) {
+	std::vector<ulongint>& sr = m_sectionRow;
+	if (sr.empty()) {
+		separation = holeSeparation;
+		offset     = holeOffset;
+		return;
+	}
+	if (row <= sr[0]) {
+		separation = m_sectionSeparation[0];
+		offset     = m_sectionOffset[0];
+		return;
+	}
+	if (row >= sr.back()) {
+		separation = m_sectionSeparation.back();
+		offset     = m_sectionOffset.back();
+		return;
 	}
+	ulongint i = std::upper_bound(sr.begin(), sr.end(), (ulongint)row) - sr.begin();
+	double fraction = (row - sr[i-1]) / double(sr[i] - sr[i-1]);
+	separation = (1.0 - fraction) * m_sectionSeparation[i-1] + fraction * m_sectionSeparation[i];
+	offset     = (1.0 - fraction) * m_sectionOffset[i-1]     + fraction * m_sectionOffset[i];
 }
 
 
 
 //////////////////////////////
 //
-// RollImage::analyzeTrackerBarPositions -- Now replaced with another algorithm
+// RollImage::getSparseCentroidHistogram -- Collect the non-zero bins of
+//    a centroid histogram as (column, count) pairs, so that the tracker
+//    shift scoring only has to visit columns containing hole centroids.
 //
 
-void RollImage::analyzeTrackerBarPositions(void) {
-	int count = (int)holeSeparation;
-	std::vector<double>& score = m_trackerShiftScores;
-	score.resize(count);
-
-	for (int i=0; i<count; i++) {
-		score[i] = getTrackerShiftScore(i);
-		// cerr << i << "\t" << score[i] << "\n";
-	}
-
-	int minindex = 0;
-	for (ulongint i=1; i<score.size(); i++) {
-		if (score[i] < score[minindex]) {
-			minindex = i;
+void RollImage::getSparseCentroidHistogram(std::vector<pair<int, int> >& bins,
+		std::vector<int>& histogram) {
+	bins.resize(0);
+	for (ulongint i=0; i<histogram.size(); i++) {
+		if (histogram[i] == 0) {
+			continue;
 		}
+		bins.push_back(make_pair((int)i, histogram[i]));
 	}
+}
 
-	double y1 = minindex < 1 ? score[count-1] : score[minindex - 1];
-	double y2 = score[minindex];
-	double y3 = minindex == count ? score[0] : score[minindex + 1];
 
-	double b = (y3 - y2)/2.0;
-	double a = y1/2.0 - y2 + y3/2.0;
-	double newi = -b / 2 / a ;
 
-	// cerr << "BASIC SEPARATION: " << minindex << " pixels\n";
-	// cerr << "REFINED SEPARATION: " << newi << " pixels\n";
-	// cerr << "FINAL ANSWER: " << (minindex + newi) << " pixels\n";
+//////////////////////////////
+//
+// RollImage::getTrackerShiftScores -- Score a grid of sub-pixel shifts
+//    of the tracker-bar pattern against the sparse centroid histogram.
+//    The grid covers one hole separation with a spacing at most the
+//    given resolution.  Each score is the count-weighted distance (in
+//    units of the separation) of the centroids from the nearest tracker
+//    position, so lower scores are better.  The phase of each bin is
+//    calculated once, so the inner loop over the grid does not need any
+//    divisions or branches.
+//
 
-	holeOffset = minindex + newi;
-	if (holeOffset > holeSeparation / 2) {
-		holeOffset = holeSeparation - holeOffset;
+void RollImage::getTrackerShiftScores(std::vector<double>& scores,
+		std::vector<pair<int, int> >& bins, double separation, double resolution) {
+	scores.resize(0);
+	if ((separation <= 0.0) || (resolution <= 0.0)) {
+		return;
+	}
+	int count = int(separation / resolution + 0.999);
+	if (count < 3) {
+		count = 3;
+	}
+	scores.resize(count);
+	std::fill(scores.begin(), scores.end(), 0.0);
+	double step = 1.0 / count;
+	double* s = scores.data();
+	for (ulongint i=0; i<bins.size(); i++) {
+		double phase = bins[i].first / separation;
+		phase -= std::floor(phase);
+		double weight = bins[i].second;
+		for (int k=0; k<count; k++) {
+			double position = phase + k * step;
+			position -= (int)position;
+			s[k] += weight * std::min(position, 1.0 - position);
+		}
 	}
-
-	// cerr << endl;
 }
 
 
 
 //////////////////////////////
 //
-// RollImage::getTrackerShiftScore --
+// RollImage::getTrackerOffset -- Return the offset of the tracker-bar
+//    pattern (in the range -separation/2 to +separation/2) which best
+//    matches the sparse centroid histogram.  The best grid point is
+//    refined with a parabolic fit through its (circular) neighbors.
+//    The grid of shift scores is stored in the scores parameter.
 //
 
-double RollImage::getTrackerShiftScore(double shift) {
-	std::vector<int>& x = correctedCentroidHistogram;
-	double score = 0.0;
-	for (ulongint i=0; i<x.size(); i++) {
-		if (x[i] == 0) {
-			continue;
-		}
-		double position = (i + shift) / holeSeparation;
-		position = position - (int)position;
-		if (position < 0.5) {
-			score += x[i] * position;
-		} else {
-			score += x[i] * (1.0 - position);
+double RollImage::getTrackerOffset(std::vector<double>& scores,
+		std::vector<pair<int, int> >& bins, double separation, double resolution) {
+	getTrackerShiftScores(scores, bins, separation, resolution);
+	int count = (int)scores.size();
+	if ((count == 0) || bins.empty()) {
+		return 0.0;
+	}
+
+	int minindex = 0;
+	for (int i=1; i<count; i++) {
+		if (scores[i] < scores[minindex]) {
+			minindex = i;
 		}
 	}
-	return score;
+
+	double y1 = scores[(minindex + count - 1) % count];
+	double y2 = scores[minindex];
+	double y3 = scores[(minindex + 1) % count];
+
+	double a = y1/2.0 - y2 + y3/2.0;
+	double b = (y3 - y1)/2.0;
+	double newi = 0.0;
+	if (a > 0.0) {
+		newi = -b / 2.0 / a;
+	}
+
+	// Centroids at column i are aligned when i + shift is a multiple of the
+	// separation, so the tracker positions are at -shift (mod separation).
+	double shift = (minindex + newi) * separation / count;
+	double offset = -shift;
+	offset -= separation * std::floor(offset / separation + 0.5);
+	return offset;
 }
 
 
@@ -1440,16 +2719,21 @@ void RollImage::analyzeTrackerBarSpacing(void) {
 	std::vector<mycomplex> spectrum;
 	int factor = 16;
 	std::vector<mycomplex> input(4096 * factor);
-	for (ulongint i=0; i<4096; i++) {
+	// Images narrower than 4096 pixels are zero padded.
+	ulongint count = std::min((ulongint)4096, (ulongint)correctedCentroidHistogram.size());
+	for (ulongint i=0; i<count; i++) {
 		input.at(i) = correctedCentroidHistogram.at(i);
 	}
-	for (ulongint i=4096; i<input.size(); i++) {
+	for (ulongint i=count; i<input.size(); i++) {
 		input.at(i) = 0.0;
 	}
 
 #ifndef DONOTUSEFFT
 
-	FFT(spectrum, input);
+	if (!FFT(spectrum, input)) {
+		setStatus(ROLL_ERROR_ANALYSIS, "FFT length must be a power of 2");
+		return;
+	}
 
 	vector<double> magnitudeSpectrum(spectrum.size());
 	int maxmagi = factor*2;
@@ -1600,7 +2884,7 @@ ulongint RollImage::processTearLeft(ulongint startrow, ulongint startcol) {
 	} else if (area < minarea) {
 		// do nothing
 	} else if (maxc - minc + 1 >= mintearwidth) {
-		TearInfo* ti = new TearInfo;
+		TearInfo* ti = m_tearPool.allocate();
 		ti->origin.first = minr;
 		ti->origin.second = minc;
 		ti->width.first = maxr - minr + 1;
@@ -1651,7 +2935,7 @@ ulongint RollImage::processTearRight(ulongint startrow, ulongint startcol) {
 	if (maxc - minc + 1 <= widththreshold) {
 		removeTearRight(minr, maxr, minc, maxc);
 	} else if (maxc - minc + 1 >= mintearwidth) {
-		TearInfo* ti = new TearInfo;
+		TearInfo* ti = m_tearPool.allocate();
 		ti->origin.first = minr;
 		ti->origin.second = minc;
 		ti->width.first = maxr - minr + 1;
@@ -1758,6 +3042,8 @@ void RollImage::analyzeTears(void) {
 	std::vector<double> swidths(rows, 0.0);  // slow width of paper
 	double sum = 0.0;
 	int counter = 0;
+	double leadersum = 0.0;
+	int leadercounter = 0;
 	for (ulongint r=0; r<rows; r++) {
 		// double fwidth = fastRight[r] - fastLeft[r];
 		double fwidth = rightMarginIndex[r] - leftMarginIndex[r];
@@ -1771,6 +3057,9 @@ void RollImage::analyzeTears(void) {
 				// don't look at leader
 				sum += swidth;
 				counter++;
+			} else {
+				leadersum += swidth;
+				leadercounter++;
 			}
 		}
 		if (fabs(fastLeft[r] - slowLeft[r]) > wfactor) {
@@ -1781,7 +3070,13 @@ void RollImage::analyzeTears(void) {
 		}
 	}
 
-	double avgwidth = sum / counter;
+	if (counter == 0) {
+		// short image (such as a range of rows at the start of the roll),
+		// so the leader has to be included:
+		sum = leadersum;
+		counter = leadercounter;
+	}
+	double avgwidth = counter > 0 ? sum / counter : 0.0;
 
 	std::vector<bool> sr(stableRegion.size(), true);
 
@@ -2203,7 +3498,7 @@ ulongint RollImage::storeShift(std::vector<double>& scores, ulongint startrow) {
 		value = minvalue;
 	}
 
-	ShiftInfo* si = new ShiftInfo;
+	ShiftInfo* si = m_shiftPool.allocate();
 	si->row = startrow + count/2;
 	si->score = value;
 	shifts.push_back(si);
@@ -2444,7 +3739,7 @@ void RollImage::analyzeHoles(void) {
 //
 
 void RollImage::extractHole(ulongint row, ulongint col) {
-	HoleInfo* hi = new HoleInfo;
+	HoleInfo* hi = m_holePool.allocate();
 
 	hi->origin.first = row;
 	hi->origin.second = col;
@@ -2478,7 +3773,7 @@ void RollImage::extractHole(ulongint row, ulongint col) {
 	} else {
 		// Too small to be considered a musical hole.
 		clearHole(*hi, PIX_ANTIDUST);
-		hi->reason = "small";
+		hi->reason = HOLE_REASON_SMALL;
 		hi->track = 0;
 		antidust.push_back(hi);
 	}
@@ -2820,27 +4115,30 @@ void RollImage::waterfallUpMargins(void) {
 // RollImage::waterfallRightMargins -- Fill in margin areas that are blocked
 //     from up/down by dust by going right from the left side of the image.
 //     This function is needed to go around fingerprints to avoid spurious
-//     hole detection on the edges of the roll.
+//     hole detection on the edges of the roll.  The fill only moves along
+//     rows, so each row is processed in turn (which is much faster than
+//     going through the image by columns).
 //
 
 void RollImage::waterfallRightMargins(void) {
 	ulongint rows = getRows();
 	ulongint cols = getCols();
 
-	for (ulongint c=0; c<cols-1; c++) {
-		for (ulongint r=0; r<rows; r++) {
-			if (pixelType.at(r).at(c) != PIX_MARGIN) {
+	for (ulongint r=0; r<rows; r++) {
+		std::vector<ucharint>& rowdata = pixelType[r];
+		for (ulongint c=0; c<cols-1; c++) {
+			if (rowdata[c] != PIX_MARGIN) {
 				continue;
 			}
-			if (pixelType.at(r).at(c+1) != PIX_PAPER) {
-				pixelType.at(r).at(c+1) = PIX_MARGIN;
+			if (rowdata[c+1] != PIX_PAPER) {
+				rowdata[c+1] = PIX_MARGIN;
 				if (c < cols/2) {
-					if (c+1 > (ulongint)leftMarginIndex.at(r)) {
-						leftMarginIndex.at(r) = c+1;
+					if (c+1 > (ulongint)leftMarginIndex[r]) {
+						leftMarginIndex[r] = c+1;
 					}
 				} else {
-					if (c+1 < (ulongint)rightMarginIndex.at(r)) {
-						rightMarginIndex.at(r-1) = c+1;
+					if (c+1 < (ulongint)rightMarginIndex[r]) {
+						rightMarginIndex[r] = c+1;
 					}
 				}
 			}
@@ -2855,27 +4153,29 @@ void RollImage::waterfallRightMargins(void) {
 // RollImage::waterfallLeftMargins -- Fill in margin areas that are blocked
 //     from up/down by dust by going left from the right side of the image.
 //     This function is needed to go around fingerprints to avoid spurious
-//     hole detection on the edges of the roll.
+//     hole detection on the edges of the roll.  As in waterfallRightMargins,
+//     the image is processed a row at a time.
 //
 
 void RollImage::waterfallLeftMargins(void) {
 	ulongint rows = getRows();
 	ulongint cols = getCols();
 
-	for (ulongint c=cols-1; c>0; c--) {
-		for (ulongint r=0; r<rows; r++) {
-			if (pixelType.at(r).at(c) != PIX_MARGIN) {
+	for (ulongint r=0; r<rows; r++) {
+		std::vector<ucharint>& rowdata = pixelType[r];
+		for (ulongint c=cols-1; c>0; c--) {
+			if (rowdata[c] != PIX_MARGIN) {
 				continue;
 			}
-			if (pixelType.at(r).at(c-1) != PIX_PAPER) {
-				pixelType.at(r).at(c-1) = PIX_MARGIN;
+			if (rowdata[c-1] != PIX_PAPER) {
+				rowdata[c-1] = PIX_MARGIN;
 				if (c < cols/2) {
-					if (c-1 > (ulongint)leftMarginIndex.at(r)) {
-						leftMarginIndex.at(r) = c-1;
+					if (c-1 > (ulongint)leftMarginIndex[r]) {
+						leftMarginIndex[r] = c-1;
 					}
 				} else {
-					if (c-1 < (ulongint)rightMarginIndex.at(r)) {
-						rightMarginIndex.at(r) = c-1;
+					if (c-1 < (ulongint)rightMarginIndex[r]) {
+						rightMarginIndex[r] = c-1;
 					}
 				}
 			}
@@ -2918,19 +4218,22 @@ void RollImage::analyzeLeaders(void) {
 	if ((topLeftAvg > botLeftAvg) && (topRightAvg < botRightAvg)) {
 		// do nothing, everything is as expected
 	} else if ((topLeftAvg < botLeftAvg) && (topRightAvg > botRightAvg) && !m_leadersAreMissing) {
-		// leader is on the bottom of the image, so don't continue processing
-		// eventually, perhaps reverse processing.
-		std::cerr << "Cannot deal with bottom leader (try -n option)" << std::endl;
-		exit(1);
+		// leader is on the bottom of the image, so analyze the rows in
+		// reverse order.
+		reverseRows();
+		std::swap(topLeftAvg, botLeftAvg);
+		std::swap(topRightAvg, botRightAvg);
 	} else if (!m_leadersAreMissing) {
-		std::cerr << "Cannot find leader (try -n option)." << std::endl;
-		std::cerr << "TOP LEFT SHOULD BE GREATER THAN BOTTOM LEFT:" << std::endl;
-		std::cerr << "   TOP    LEFT  AVERAGE " << topLeftAvg << std::endl;
-		std::cerr << "   BOTTOM LEFT  AVERAGE " << botLeftAvg << std::endl;
-		std::cerr << "TOP RIGHT SHOULD BE GREATER THAN BOTTOM RIGHT:" << std::endl;
-		std::cerr << "TOP    RIGHT AVERAGE " << topRightAvg << std::endl;
-		std::cerr << "BOTTOM RIGHT AVERAGE " << botRightAvg << std::endl;
-		exit(1);
+		std::stringstream message;
+		message << "Cannot find leader (try -n option)." << std::endl;
+		message << "TOP LEFT SHOULD BE GREATER THAN BOTTOM LEFT:" << std::endl;
+		message << "   TOP    LEFT  AVERAGE " << topLeftAvg << std::endl;
+		message << "   BOTTOM LEFT  AVERAGE " << botLeftAvg << std::endl;
+		message << "TOP RIGHT SHOULD BE GREATER THAN BOTTOM RIGHT:" << std::endl;
+		message << "TOP    RIGHT AVERAGE " << topRightAvg << std::endl;
+		message << "BOTTOM RIGHT AVERAGE " << botRightAvg;
+		setStatus(ROLL_ERROR_LEADER, message.str());
+		return;
 	}
 
 	ulongint leftLeaderBoundary = 0;
@@ -2956,6 +4259,56 @@ void RollImage::analyzeLeaders(void) {
 
 
 
+//////////////////////////////
+//
+// RollImage::addImageOriginsToHoles -- Store the origin of each hole in the
+//   input image frame when the rows or columns were analyzed in reverse
+//   order, rows were removed or only a range of rows was analyzed.  The
+//   image origin is the top left corner of the hole in the input image.
+//
+
+void RollImage::addImageOriginsToHoles(void) {
+	bool droppedrows = (m_duplicateMode == DUPLICATES_DROP) && !duplicates.empty();
+	if (!(m_reversedRows || m_mirroredCols || droppedrows || m_rowRange)) {
+		return;
+	}
+	std::vector<std::vector<HoleInfo*>*> lists = {&holes, &badHoles, &antidust};
+	for (auto list : lists) {
+		for (auto hi : *list) {
+			ulongint row = hi->origin.first;
+			ulongint col = hi->origin.second;
+			if (m_reversedRows) {
+				row += hi->width.first - 1;
+			}
+			if (m_mirroredCols) {
+				col += hi->width.second - 1;
+			}
+			hi->imageorigin.first  = getImageRow(row);
+			hi->imageorigin.second = getImageCol(col);
+			hi->reoriented = true;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::reverseRows -- Reverse the order of the rows in the image
+//   data and margins so that the leader is at the start.  Only the row
+//   vectors are exchanged, not the pixels that they contain.
+//
+
+void RollImage::reverseRows(void) {
+	std::reverse(monochrome.begin(), monochrome.end());
+	std::reverse(pixelType.begin(), pixelType.end());
+	std::reverse(leftMarginIndex.begin(), leftMarginIndex.end());
+	std::reverse(rightMarginIndex.begin(), rightMarginIndex.end());
+	m_reversedRows = !m_reversedRows;
+}
+
+
+
 //////////////////////////////
 //
 // findLeftLeaderBoundary --
@@ -3040,225 +4393,532 @@ ulongint RollImage::getBoundary(std::vector<int>& status) {
 
 //////////////////////////////
 //
-// RollImage::mergePixelOverlay --
+// RollImage::writeStraightenedImage -- Write a copy of the input image
+//   with each row shifted by its drift correction so that the columns of
+//   holes are vertical, as the straighten tool does from the DRIFT
+//   section of the analysis.  The input is read once more in large blocks
+//   (from memory if it was loaded or mapped), and the rows of each block
+//   are shifted by separate threads (0 = one for each processor) before
+//   the block is written.  Shifts are rounded to whole pixels unless
+//   subpixel is true, in which case neighboring pixels are linearly
+//   interpolated.  Pixels which are uncovered by the shift are set to the
+//   brightness value.  The analysis must have been done (see analyze).
+//   default value: subpixel   = false
+//   default value: brightness = 254
+//   default value: threads    = 0
+//
+
+bool RollImage::writeStraightenedImage(const std::string& filename, bool subpixel,
+		int brightness, int threads) {
+	if (!segments.empty()) {
+		cerr << "Cannot straighten an image stitched from segments" << endl;
+		return false;
+	}
+	if (driftCorrection.empty()) {
+		cerr << "The drift analysis is needed to straighten the image" << endl;
+		return false;
+	}
+	if (filename == getFilename()) {
+		cerr << "Error: Input and output files cannot be the same" << endl;
+		return false;
+	}
+
+	// The header of this image may have been adjusted for the analysis
+	// (dropped duplicate frames or a row range), so read the input again
+	// with its own header.
+	TiffFile source;
+	if (!source.openInput(*this)) {
+		return false;
+	}
+	int bits = source.getBitsPerSample();
+	if (((bits != 8) && (bits != 16)) || (source.isPlanar() && !source.isMonochrome())) {
+		cerr << "Can only straighten 8-bit or 16-bit images with interleaved samples"
+		     << endl;
+		return false;
+	}
+	ulongint rows = source.getRows();
+	ulongint cols = source.getCols();
+	ulonglongint rowbytes = (ulonglongint)cols * source.getBytesPerPixel();
+	ulonglongint dataoffset = source.getDataOffset();
+	ulonglongint dataend = dataoffset + rows * rowbytes;
+	ulonglongint inputsize = source.getInputSize();
+	if (dataend > inputsize) {
+		cerr << "Image data extends past the end of the input" << endl;
+		return false;
+	}
+	brightness = std::max(0, std::min(255, brightness));
+
+	std::vector<double> drift;
+	getImageDrift(drift, rows);
+
+	fstream output;
+	output.open(filename.c_str(), ios::binary | ios::out);
+	if (!output.is_open()) {
+		cerr << "Output filename " << filename << " cannot be opened" << endl;
+		return false;
+	}
+
+	ulongint blockrows = std::max((ulongint)1, (ulongint)(STRAIGHTEN_BLOCK_BYTES / rowbytes));
+	blockrows = std::min(blockrows, std::max((ulongint)1, rows));
+	std::vector<ucharint> input(blockrows * rowbytes);
+	std::vector<ucharint> shifted(blockrows * rowbytes);
+
+	// Copy the header and anything else before the image data:
+	for (ulonglongint i=0; i<dataoffset; i+=input.size()) {
+		ulonglongint count = std::min((ulonglongint)input.size(), dataoffset - i);
+		if (!source.readBytes(input.data(), i, count)) {
+			cerr << "Cannot read the image header" << endl;
+			return false;
+		}
+		output.write((char*)input.data(), count);
+	}
+
+	threads = ChannelHistogram::getThreadCount(threads, blockrows);
+	for (ulongint r=0; r<rows; r+=blockrows) {
+		ulongint count = std::min(blockrows, rows - r);
+		if (!source.readBytes(input.data(), dataoffset + r * rowbytes, count * rowbytes)) {
+			cerr << "Cannot read image data at row " << r << endl;
+			return false;
+		}
+		std::vector<std::thread> workers;
+		for (int t=0; t<threads; t++) {
+			ulongint startrow = count * t / threads;
+			ulongint endrow   = count * (t + 1) / threads;
+			workers.emplace_back([this, &source, &input, &shifted, &drift, r, startrow,
+					endrow, rowbytes, cols, subpixel, brightness]() {
+				for (ulongint i=startrow; i<endrow; i++) {
+					straightenRow(shifted.data() + i * rowbytes, input.data() + i * rowbytes,
+							cols, drift[r + i], subpixel, brightness, source);
+				}
+			});
+		}
+		for (ulongint t=0; t<workers.size(); t++) {
+			workers[t].join();
+		}
+		output.write((char*)shifted.data(), count * rowbytes);
+	}
+
+	// Copy anything after the image data (such as the directory):
+	for (ulonglongint i=dataend; i<inputsize; i+=input.size()) {
+		ulonglongint count = std::min((ulonglongint)input.size(), inputsize - i);
+		if (!source.readBytes(input.data(), i, count)) {
+			cerr << "Cannot read the end of the image file" << endl;
+			return false;
+		}
+		output.write((char*)input.data(), count);
+	}
+
+	output.close();
+	if (output.fail()) {
+		cerr << "Could not write " << filename << endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getImageDrift -- Convert the drift correction of the rows
+//   in the analysis frame into column shifts for each row of the input
+//   image (which may be reversed or mirrored).  As in the DRIFT section
+//   of the analysis, the drift is measured from the first music hole, and
+//   held constant before it and after the last music hole.  Rows of the
+//   image which were not analyzed (dropped duplicate frames or rows outside
+//   of a row range) use the drift of the nearest analyzed row before them.
 //
 
-void RollImage::mergePixelOverlay(std::fstream& output) {
-	std::vector<ucharint> pixel(3);
-	ulonglongint offset;
-	ulongint rows = getRows();
-	ulongint cols = getCols();
+void RollImage::getImageDrift(std::vector<double>& drift, ulongint imagerows) {
+	drift.assign(imagerows, 0.0);
+	ulongint rows = std::min((ulongint)driftCorrection.size(), (ulongint)getRows());
+	if ((rows == 0) || (imagerows == 0)) {
+		return;
+	}
+	ulongint end   = getLastMusicHoleEnd();
+	ulongint first = std::min(getFirstMusicHoleStart(), rows - 1);
+	ulongint last  = std::max(first, std::min(end > 0 ? end - 1 : 0, rows - 1));
+	double offset = driftCorrection[first];
+	double direction = m_mirroredCols ? -1.0 : 1.0;
 
+	std::vector<ucharint> analyzed(imagerows, 0);
 	for (ulongint r=0; r<rows; r++) {
-		for (ulongint c=0; c<cols; c++) {
-			int value = pixelType[r][c];
-			if (!value) {
-				continue;
+		ulongint row = getImageRow(r);
+		if (row >= imagerows) {
+			continue;
+		}
+		ulongint index = std::min(std::max(r, first), last);
+		drift[row] = direction * (driftCorrection[index] - offset);
+		analyzed[row] = 1;
+	}
+
+	ulongint start = 0;
+	while ((start < imagerows) && !analyzed[start]) {
+		start++;
+	}
+	if (start >= imagerows) {
+		return;
+	}
+	for (ulongint r=0; r<start; r++) {
+		drift[r] = drift[start];
+	}
+	for (ulongint r=start+1; r<imagerows; r++) {
+		if (!analyzed[r]) {
+			drift[r] = drift[r-1];
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::straightenRow -- Shift a row of pixels to the right by the
+//   given number of columns (to the left if negative).  When subpixel is
+//   true, each output sample is interpolated from the two input pixels
+//   nearest to its shifted position (in steps of 1/256 of a pixel).
+//
+
+void RollImage::straightenRow(ucharint* output, const ucharint* input, ulongint cols,
+		double shift, bool subpixel, int brightness, TiffHeader& format) {
+	int bpp = format.getBytesPerPixel();
+	long ishift = subpixel ? (long)floor(shift) : lround(shift);
+	int weight = subpixel ? (int)((shift - ishift) * 256.0 + 0.5) : 0;
+	if (weight == 256) {
+		ishift++;
+		weight = 0;
+	}
+
+	std::memset(output, brightness, (ulonglongint)cols * bpp);
+	if ((ulongint)std::abs(ishift) >= cols) {
+		return;
+	}
+
+	if (weight == 0) {
+		ulongint start = ishift > 0 ? ishift : 0;
+		ulongint count = cols - std::abs(ishift);
+		std::memcpy(output + start * bpp, input + (start - ishift) * bpp, count * bpp);
+		return;
+	}
+
+	// Interpolate each sample between the pixel which is shifted by ishift
+	// (weight 256 - weight) and the one before it (weight weight), treating
+	// pixels beyond the edges of the row as the brightness value:
+	int bytes = format.getBitsPerSample() / 8;
+	int spp = bpp / bytes;
+	bool bigendian = format.isBigEndian();
+	int fill = bytes == 2 ? brightness * 257 : brightness;
+	auto getSample = [&](long col, int sample) {
+		if ((col < 0) || (col >= (long)cols)) {
+			return fill;
+		}
+		const ucharint* data = input + (col * spp + sample) * bytes;
+		if (bytes == 1) {
+			return (int)data[0];
+		}
+		return bigendian ? (data[0] << 8) | data[1] : (data[1] << 8) | data[0];
+	};
+
+	long startcol = std::max(0L, ishift);
+	long endcol = std::min((long)cols, (long)cols + ishift + 1);
+	for (long c=startcol; c<endcol; c++) {
+		for (int s=0; s<spp; s++) {
+			int value = (getSample(c - ishift, s) * (256 - weight) +
+					getSample(c - ishift - 1, s) * weight + 128) >> 8;
+			ucharint* data = output + (c * spp + s) * bytes;
+			if (bytes == 1) {
+				data[0] = (ucharint)value;
+			} else if (bigendian) {
+				data[0] = (ucharint)(value >> 8);
+				data[1] = (ucharint)(value & 0xff);
+			} else {
+				data[0] = (ucharint)(value & 0xff);
+				data[1] = (ucharint)(value >> 8);
 			}
-			switch (value) {
-				case PIX_NONPAPER:         // undifferentiated non-paper (green)
-					pixel[0] = 0;
-					pixel[1] = 255;
-					pixel[2] = 0;
-					break;
+		}
+	}
+}
 
-				case PIX_MARGIN:           // paper margins (blue)
-					pixel[0] = 0;
-					pixel[1] = 0;
-					pixel[2] = 255;
-					break;
 
-				case PIX_HARDMARGIN:       // paper margins with not paper in rect.
-					pixel[0] = 0;
-					pixel[1] = 64;
-					pixel[2] = 255;
-					break;
 
-				case PIX_LEADER:           // leader region (cyan)
-					pixel[0] = 0;
-					pixel[1] = 255;
-					pixel[2] = 255;
-					break;
+//////////////////////////////
+//
+// RollImage::canMergePixelOverlay -- True if the analysis markup can be
+//   written into a copy of the input image: a single color (RGB) image of
+//   8-bit or 16-bit samples.  Otherwise the reason is printed.
+//
 
-				case PIX_PRELEADER:        // pre-leader region (light blue)
-					pixel[0] = 0;
-					pixel[1] = 128;
-					pixel[2] = 255;
-					break;
+bool RollImage::canMergePixelOverlay(void) {
+	if (!segments.empty()) {
+		cerr << "Cannot write the pixel overlay for an image stitched from segments"
+		     << endl;
+		return false;
+	}
+	if (getSamplesPerPixel() < 3) {
+		cerr << "Cannot write the colored pixel overlay into a monochrome image"
+		     << endl;
+		return false;
+	}
+	if ((getBitsPerSample() != 8) && (getBitsPerSample() != 16)) {
+		cerr << "Cannot write the pixel overlay into an image with "
+		     << getBitsPerSample() << "-bit samples" << endl;
+		return false;
+	}
+	return true;
+}
 
-				case PIX_POSTLEADER:       // post-leader region (lighter blue)
-					pixel[0] = 128;
-					pixel[1] = 128;
-					pixel[2] = 255;
-					break;
 
-				case PIX_POSTMUSIC:       // post-music region (lighter blue)
-					pixel[0] = 128;
-					pixel[1] = 128;
-					pixel[2] = 255;
-					break;
 
-				case PIX_TEAR:             // tears at edge of roll (magenta)
-					pixel[0] = 255;
-					pixel[1] = 0;
-					pixel[2] = 255;
-					break;
+//////////////////////////////
+//
+// RollImage::mergePixelOverlay -- Color the pixels of a copy of the input
+//   image according to their type in the analysis.  The colors are
+//   written at the bit depth, byte order and sample layout (interleaved
+//   or planar) of the input image.  Returns false if the image format
+//   cannot take the overlay (see canMergePixelOverlay).
+//
 
-				case PIX_ANTIDUST:         // non-musical holes in roll (light-magenta)
-					pixel[0] = 255;
-					pixel[1] = 128;
-					pixel[2] = 255;
-					break;
+bool RollImage::mergePixelOverlay(std::fstream& output) {
+	if (!canMergePixelOverlay()) {
+		return false;
+	}
+	std::vector<ucharint> pixel(3);
+	ulongint rows = getRows();
+	ulongint cols = getCols();
+	int samplebytes = getBitsPerSample() / 8;
+	bool planar = isPlanar();
+	// samples: the overlay color at the bit depth of the image (16-bit
+	// samples have the same value in both bytes, so the byte order of the
+	// image does not matter).
+	std::vector<ucharint> samples(3 * samplebytes);
+	// Planar images are written one plane at a time so that the writes
+	// stay in order in the file.
+	int planes = planar ? 3 : 1;
+
+	for (int plane=0; plane<planes; plane++) {
+		for (ulongint r=0; r<rows; r++) {
+			for (ulongint c=0; c<cols; c++) {
+				int value = pixelType[r][c];
+				if (!value) {
+					continue;
+				}
+				switch (value) {
+					case PIX_NONPAPER:         // undifferentiated non-paper (green)
+						pixel[0] = 0;
+						pixel[1] = 255;
+						pixel[2] = 0;
+						break;
 
-				case PIX_HOLE:             // musical holes in roll (cornflowerblue)
-					pixel[0] = 100;
-					pixel[1] = 149;
-					pixel[2] = 237;
-					break;
+					case PIX_MARGIN:           // paper margins (blue)
+						pixel[0] = 0;
+						pixel[1] = 0;
+						pixel[2] = 255;
+						break;
 
-				case PIX_HOLE_SNAKEBITE:   // snake bites (red)
-					pixel[0] = 255;
-					pixel[1] =   0;
-					pixel[2] =   0;
-					break;
+					case PIX_HARDMARGIN:       // paper margins with not paper in rect.
+						pixel[0] = 0;
+						pixel[1] = 64;
+						pixel[2] = 255;
+						break;
 
-				case PIX_HOLE_SHIFT:       // musical holes in roll (lightblue)
-					pixel[0] = 173;
-					pixel[1] = 216;
-					pixel[2] = 230;
-					break;
+					case PIX_LEADER:           // leader region (cyan)
+						pixel[0] = 0;
+						pixel[1] = 255;
+						pixel[2] = 255;
+						break;
 
-				case PIX_BADHOLE:          // non-musical hole but significant (magenta)
-					pixel[0] = 255;
-					pixel[1] = 0;
-					pixel[2] = 255;
-					break;
+					case PIX_PRELEADER:        // pre-leader region (light blue)
+						pixel[0] = 0;
+						pixel[1] = 128;
+						pixel[2] = 255;
+						break;
 
-				case PIX_BADHOLE_SKEWED:   // non-musical hole which is skewed (deep pink)
-					pixel[0] = 255;
-					pixel[1] =  20;
-					pixel[2] = 147;
-					break;
+					case PIX_POSTLEADER:       // post-leader region (lighter blue)
+						pixel[0] = 128;
+						pixel[1] = 128;
+						pixel[2] = 255;
+						break;
 
-				case PIX_BADHOLE_ASPECT:   // non-musical hole which has a bad aspect ratio (springgreen)
-					pixel[0] = 0;
-					pixel[1] = 255;
-					pixel[2] = 127;
-					break;
+					case PIX_POSTMUSIC:       // post-music region (lighter blue)
+						pixel[0] = 128;
+						pixel[1] = 128;
+						pixel[2] = 255;
+						break;
 
-				case PIX_HOLEBB:           // musical hole bounding box (red)
-					pixel[0] = 255;
-					pixel[1] =   0;
-					pixel[2] =   0;
-					break;
+					case PIX_TEAR:             // tears at edge of roll (magenta)
+						pixel[0] = 255;
+						pixel[1] = 0;
+						pixel[2] = 255;
+						break;
 
-				case PIX_HOLEBB_LEADING_A:   // musical hole attack edge (yellow)
-					pixel[0] = 255;
-					pixel[1] = 255;
-					pixel[2] =   0;
-					break;
+					case PIX_ANTIDUST:         // non-musical holes in roll (light-magenta)
+						pixel[0] = 255;
+						pixel[1] = 128;
+						pixel[2] = 255;
+						break;
 
-				case PIX_HOLEBB_LEADING_S:   // musical hole leading edge, sustain  (orange)
-					pixel[0] = 255;
-					pixel[1] = 165;
-					pixel[2] =   0;
-					break;
+					case PIX_HOLE:             // musical holes in roll (cornflowerblue)
+						pixel[0] = 100;
+						pixel[1] = 149;
+						pixel[2] = 237;
+						break;
 
-				case PIX_HOLEBB_TRAILING:  // musical hole bounding box (red)
-					pixel[0] = 255;
-					pixel[1] =   0;
-					pixel[2] =   0;
-					break;
+					case PIX_HOLE_SNAKEBITE:   // snake bites (red)
+						pixel[0] = 255;
+						pixel[1] =   0;
+						pixel[2] =   0;
+						break;
 
-				case PIX_HOLEBB_BASS:      // musical hole bounding box (orange)
-					pixel[0] = 255;
-					pixel[1] = 165;
-					pixel[2] =   0;
-					break;
+					case PIX_HOLE_SHIFT:       // musical holes in roll (lightblue)
+						pixel[0] = 173;
+						pixel[1] = 216;
+						pixel[2] = 230;
+						break;
 
-				case PIX_HOLEBB_TREBLE:    // musical hole bounding box (red)
-					pixel[0] = 255;
-					pixel[1] =   0;
-					pixel[2] =   0;
-					break;
+					case PIX_BADHOLE:          // non-musical hole but significant (magenta)
+						pixel[0] = 255;
+						pixel[1] = 0;
+						pixel[2] = 255;
+						break;
 
-				case PIX_TRACKER:           // hole for tracker position (green)
-					pixel[0] =   0;
-					pixel[1] = 255;
-					pixel[2] =   0;
-					break;
+					case PIX_BADHOLE_SKEWED:   // non-musical hole which is skewed (deep pink)
+						pixel[0] = 255;
+						pixel[1] =  20;
+						pixel[2] = 147;
+						break;
 
-				case PIX_TRACKER_BASS:      // hole for bass tracker position (green)
-					pixel[0] =   0;
-					pixel[1] = 255;
-					pixel[2] =   0;
-					break;
+					case PIX_BADHOLE_ASPECT:   // non-musical hole which has a bad aspect ratio (springgreen)
+						pixel[0] = 0;
+						pixel[1] = 255;
+						pixel[2] = 127;
+						break;
 
-				case PIX_TRACKER_TREBLE:    // hole for treble tracker position (cyan)
-					pixel[0] =   0;
-					pixel[1] = 255;
-					pixel[2] = 255;
-					break;
+					case PIX_HOLEBB:           // musical hole bounding box (red)
+						pixel[0] = 255;
+						pixel[1] =   0;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG:				 // white
-					pixel[0] = 255;
-					pixel[1] = 255;
-					pixel[2] = 255;
-					break;
+					case PIX_HOLEBB_LEADING_A:   // musical hole attack edge (yellow)
+						pixel[0] = 255;
+						pixel[1] = 255;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG1:				// red
-					pixel[0] = 255;
-					pixel[1] = 0;
-					pixel[2] = 0;
-					break;
+					case PIX_HOLEBB_LEADING_S:   // musical hole leading edge, sustain  (orange)
+						pixel[0] = 255;
+						pixel[1] = 165;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG2:				// orange
-					pixel[0] = 255;
-					pixel[1] = 153;
-					pixel[2] = 127;
-					break;
+					case PIX_HOLEBB_TRAILING:  // musical hole bounding box (red)
+						pixel[0] = 255;
+						pixel[1] =   0;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG3:				// yellow
-					pixel[0] = 255;
-					pixel[1] = 255;
-					pixel[2] = 0;
-					break;
+					case PIX_HOLEBB_BASS:      // musical hole bounding box (orange)
+						pixel[0] = 255;
+						pixel[1] = 165;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG4:				// green
-					pixel[0] = 50;
-					pixel[1] = 255;
-					pixel[2] = 50;
-					break;
+					case PIX_HOLEBB_TREBLE:    // musical hole bounding box (red)
+						pixel[0] = 255;
+						pixel[1] =   0;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG5:				// light blue
-					pixel[0] = 0;
-					pixel[1] = 255;
-					pixel[2] = 255;
-					break;
+					case PIX_TRACKER:           // hole for tracker position (green)
+						pixel[0] =   0;
+						pixel[1] = 255;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG6:				// dark blue
-					pixel[0] = 0;
-					pixel[1] = 0;
-					pixel[2] = 255;
-					break;
+					case PIX_TRACKER_BASS:      // hole for bass tracker position (green)
+						pixel[0] =   0;
+						pixel[1] = 255;
+						pixel[2] =   0;
+						break;
 
-				case PIX_DEBUG7:				// purple
-					pixel[0] = 150;
-					pixel[1] = 50;
-					pixel[2] = 255;
-					break;
+					case PIX_TRACKER_TREBLE:    // hole for treble tracker position (cyan)
+						pixel[0] =   0;
+						pixel[1] = 255;
+						pixel[2] = 255;
+						break;
+
+					case PIX_DEBUG:				 // white
+						pixel[0] = 255;
+						pixel[1] = 255;
+						pixel[2] = 255;
+						break;
+
+					case PIX_DEBUG1:				// red
+						pixel[0] = 255;
+						pixel[1] = 0;
+						pixel[2] = 0;
+						break;
 
-				default:
-					pixel[0] = 255;
-					pixel[1] = 255;
-					pixel[2] = 255;
+					case PIX_DEBUG2:				// orange
+						pixel[0] = 255;
+						pixel[1] = 153;
+						pixel[2] = 127;
+						break;
+
+					case PIX_DEBUG3:				// yellow
+						pixel[0] = 255;
+						pixel[1] = 255;
+						pixel[2] = 0;
+						break;
+
+					case PIX_DEBUG4:				// green
+						pixel[0] = 50;
+						pixel[1] = 255;
+						pixel[2] = 50;
+						break;
+
+					case PIX_DEBUG5:				// light blue
+						pixel[0] = 0;
+						pixel[1] = 255;
+						pixel[2] = 255;
+						break;
+
+					case PIX_DEBUG6:				// dark blue
+						pixel[0] = 0;
+						pixel[1] = 0;
+						pixel[2] = 255;
+						break;
+
+					case PIX_DEBUG7:				// purple
+						pixel[0] = 150;
+						pixel[1] = 50;
+						pixel[2] = 255;
+						break;
+
+					default:
+						pixel[0] = 255;
+						pixel[1] = 255;
+						pixel[2] = 255;
 
+				}
+				for (int i=0; i<3; i++) {
+					for (int j=0; j<samplebytes; j++) {
+						samples[i * samplebytes + j] = pixel[i];
+					}
+				}
+				ulongint row = getImageRow(r);
+				ulongint col = getImageCol(c);
+				if (planar) {
+					rip::goToByteIndex(output, this->getSampleOffset(row, col, plane));
+					output.write((char*)samples.data() + plane * samplebytes, samplebytes);
+				} else {
+					rip::goToByteIndex(output, this->getSampleOffset(row, col, 0));
+					output.write((char*)samples.data(), samples.size());
+				}
 			}
-			offset = this->getPixelOffset(r, c);
-			rip::goToByteIndex(output, offset);
-			output.write((char*)pixel.data(), 3);
 		}
 	}
+	return true;
 }
 
 
@@ -4151,7 +5811,7 @@ double RollImage::getDustScore(void) {
 // RollImage::getDustScoreBass -- Probably do not need to count all of the
 //   dust the entire roll, since the dust particles will cycle through the
 //   scanning region every 6.47 inches. Reported value is in parts per million
-//   (ppm).
+//   (ppm).  See setDustSampling() for counting only some of the rows.
 //
 
 double RollImage::getDustScoreBass(void) {
@@ -4159,28 +5819,7 @@ double RollImage::getDustScoreBass(void) {
 		return m_dustscorebass;
 	}
 
-	ulongint counter = 0;
-	ulongint startcol = 0;
-	ulongint endcol = hardMarginLeftIndex;
-	ulongint startrow = getFirstMusicHoleStart();
-	ulongint endrow   = getLastMusicHoleEnd();
-
-	for (ulongint r=startrow; r<=endrow; r++) {
-		for (ulongint c=startcol; c<=endcol; c++) {
-			if (pixelType[r][c] == PIX_PAPER) {
-				counter++;
-			} else if (pixelType[r][c] == PIX_NONPAPER) {
-				// this is technically not paper, but there should
-				// be no PIX_NONPAPER in hard margin region.  When
-				// there is, that means there is a lot of dust around,
-				// so treat the dust-shadowed region as dust itself.
-				counter++;
-			}
-		}
-	}
-
-	double marginarea = (endcol - startcol + 1) * (endrow - startrow + 1);
-	m_dustscorebass = (double)counter / marginarea * 1000000.0;
+	m_dustscorebass = countMarginDust(0, hardMarginLeftIndex, m_dustscorebasserror);
 	return int(m_dustscorebass + 0.5);
 }
 
@@ -4196,29 +5835,96 @@ double RollImage::getDustScoreTreble(void) {
 		return m_dustscoretreble;
 	}
 
-	ulongint counter = 0;
-	ulongint startcol = hardMarginRightIndex;
-	ulongint endcol = getCols() - 1;
+	m_dustscoretreble = countMarginDust(hardMarginRightIndex, getCols() - 1,
+			m_dustscoretrebleerror);
+	return int(m_dustscoretreble + 0.5);
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::getDustScoreError -- Return the half-width of the 95%
+//   confidence interval of getDustScore() in ppm, which is 0 unless the
+//   dust was counted in a sample of the rows (see setDustSampling).
+//
+
+double RollImage::getDustScoreError(void) {
+	getDustScoreBass();
+	getDustScoreTreble();
+	return std::sqrt(m_dustscorebasserror * m_dustscorebasserror +
+			m_dustscoretrebleerror * m_dustscoretrebleerror) / 2.0;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setDustSampling -- Count the dust in only every step rows of
+//   the hard margins (default 1 for every row).  The step should not be a
+//   factor of the 6.47-inch cycle of the dust on the scanner (1941 rows at
+//   300 DPI), so that the sample covers the whole cycle.  The score is then
+//   an estimate, with its confidence interval from getDustScoreError().
+//   This must be set before the dust scores are calculated.
+//
+
+void RollImage::setDustSampling(ulongint step) {
+	m_dustSampleStep = step > 0 ? step : 1;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::countMarginDust -- Return the dust in the given columns of
+//   the music region in parts per million, counting every m_dustSampleStep
+//   rows.  When rows are skipped, error is set to the half-width of the 95%
+//   confidence interval of the score, from the variation of the dust
+//   counts in the sampled rows (with the finite population correction),
+//   or from the "rule of three" if no dust was found in the sample;
+//   otherwise it is 0.
+//
+
+double RollImage::countMarginDust(ulongint startcol, ulongint endcol, double& error) {
 	ulongint startrow = getFirstMusicHoleStart();
 	ulongint endrow   = getLastMusicHoleEnd();
+	ulongint step     = m_dustSampleStep;
 
-	for (ulongint r=startrow; r<=endrow; r++) {
+	ulongint counter = 0;
+	ulongint samples = 0;
+	double   sumsq   = 0.0;
+	for (ulongint r=startrow; r<=endrow; r+=step) {
+		std::vector<ucharint>& rowdata = pixelType[r];
+		ulongint count = 0;
 		for (ulongint c=startcol; c<=endcol; c++) {
-			if (pixelType[r][c] == PIX_PAPER) {
-				counter++;
-			} else if (pixelType[r][c] == PIX_NONPAPER) {
+			if (rowdata[c] == PIX_PAPER) {
+				count++;
+			} else if (rowdata[c] == PIX_NONPAPER) {
 				// this is technically not paper, but there should
 				// be no PIX_NONPAPER in hard margin region.  When
 				// there is, that means there is a lot of dust around,
 				// so treat the dust-shadowed region as dust itself.
-				counter++;
+				count++;
 			}
 		}
+		counter += count;
+		sumsq += (double)count * count;
+		samples++;
 	}
 
-	double marginarea = (endcol - startcol + 1) * (endrow - startrow + 1);
-	m_dustscoretreble = (double)counter / marginarea * 1000000.0;
-	return int(m_dustscoretreble + 0.5);
+	ulongint width = endcol - startcol + 1;
+	double marginarea = width * samples;
+	error = 0.0;
+	if ((step > 1) && (samples > 1)) {
+		double mean = (double)counter / samples;
+		double variance = (sumsq - samples * mean * mean) / (samples - 1);
+		double fpc = 1.0 - (double)samples / (endrow - startrow + 1);
+		error = 1.96 * std::sqrt(std::max(0.0, variance) / samples * fpc) / width * 1000000.0;
+		if (counter == 0) {
+			error = 3.0 / marginarea * 1000000.0;
+		}
+	}
+	return (double)counter / marginarea * 1000000.0;
 }
 
 
@@ -4338,6 +6044,9 @@ void RollImage::addDriftInfoToHoles(void) {
 //
 
 std::string RollImage::getDataMD5Sum(void) {
+	if (!m_channelMD5.empty()) {
+		return m_channelMD5;
+	}
 	CheckSum checksum;
 	return checksum.getMD5Sum(monochrome);
 }
@@ -4405,6 +6114,55 @@ void RollImage::generateHoleMidiFileBinasc(ostream& output) {
 
 
 
+//////////////////////////////
+//
+// RollImage::writeNoteMidiFile -- Write a binary Standard MIDI File where
+//    holes are grouped into notes.
+//
+
+bool RollImage::writeNoteMidiFile(ostream& output) {
+#ifndef DONOTUSEFFT
+	MidiFile midifile;
+	generateMidifile(midifile);
+	return midifile.write(output);
+#else
+	return false;
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::writeHoleMidiFile -- Write a binary Standard MIDI File where
+//    holes are not grouped into notes.
+//
+
+bool RollImage::writeHoleMidiFile(ostream& output) {
+#ifndef DONOTUSEFFT
+	MidiFile midifile;
+	generateHoleMidifile(midifile);
+	return midifile.write(output);
+#else
+	return false;
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::setEmbeddedMidiFiles -- Include (true) or suppress (false) the
+//    MIDIFILES section of the analysis report, which contains the note and
+//    hole MIDI files in Binasc format.  Default value: true.
+//
+
+void RollImage::setEmbeddedMidiFiles(bool value) {
+	m_embedMidiFiles = value;
+}
+
+
+
 //////////////////////////////
 //
 // RollImage::generateHoleMidifile --
@@ -4463,65 +6221,22 @@ void RollImage::generateHoleMidifile(MidiFile& midifile) {
 	midifile.addController(m_bass_track,       tick, m_bass_ch,   10, 32); // bass notes pan leftish
 	midifile.addController(m_treble_track,     tick, m_treble_ch, 10, 96); // treble notes pan rightish
 
-	ulongint mintime = holes[0]->origin.first;
-	ulongint maxtime = 0;
-
-	int track;
-	int key;
-	int channel;
-	int velocity;
-	bool attackQ = false;
-
-	for (ulongint i=0; i<holes.size(); i++) {
-		if (holes[i]->attack) {
-			attackQ = true;
-		} else {
-			attackQ = false;
-		}
-		HoleInfo* hi = holes[i];
-		key = hi->midikey;
-
-		// estimate the location of the expression tracks and the
-		// bass/treble register split (refine later):
-		if (key < m_bassNotesTrackStartMidi) { // Bass expression
-			track    = m_bass_exp_track;
-			channel  = m_bass_exp_ch;
-			velocity = 32; // quiet
-		} else if (key < m_trebleNotesTrackStartMidi) { // Bass register
-			track    = m_bass_track;
-			channel  = m_bass_ch;
-			velocity = 64; // mf for now; will be refined by expression rendering later
-			if (attackQ) {
-				velocity += 32;
-			} else {
-				velocity -= 16;
-			}
-		} else if (key < m_trebleExpressionTrackStartMidi) {  // Treble register
-			track    = m_treble_track;
-			channel  = m_treble_ch;
-			velocity = 64;  // mf for now; will be refined by expression rendering later
-			if (attackQ) {
-				velocity += 32;
-			} else {
-				velocity -= 16;
-			}
-		} else { // Treble expression
-			track    = m_treble_exp_track;
-			channel  = m_treble_exp_ch;
-			velocity = 32; // quiet
-		}
-
-		midifile.addNoteOn(track, hi->origin.first - mintime, channel, hi->midikey, velocity);
-		midifile.addNoteOff(track, hi->origin.first - mintime + hi->width.first, channel, hi->midikey);
-		if (hi->offtime > maxtime) {
-			maxtime = hi->offtime;
-		}
+	buildMidiEventTable();
+	std::vector<MidiNoteInfo>& table = midiEvents;
+	if (table.empty()) {
+		return;
+	}
+	long mintime = table[0].ontick;
 
+	std::vector<MidiNoteInfo> notes(table);
+	for (ulongint i=0; i<notes.size(); i++) {
+		notes[i].ontick  -= mintime;
+		notes[i].offtick -= mintime;
 	}
 
 	// should also add bad holes into track 5 here.
 
-	midifile.sortTracks();
+	addSortedNotes(midifile, notes);
 }
 #endif
 
@@ -4690,67 +6405,56 @@ void RollImage::generateMidifile(MidiFile& midifile) {
 	ulongint mintime = firstMusicRow;
 	ulongint maxtime = 0;
 
-	int track;
-	int key;
-	int channel;
 	int velocityquiet = 1;
 	int velocitynormal = 64;
-	int velocity;
 	if (!hasExpressionRegions) {
 		velocityquiet= 64;
 	}
-	for (ulongint i=0; i<holes.size(); i++) {
-		if (!holes[i]->attack) {
+
+	buildMidiEventTable();
+	std::vector<MidiNoteInfo>& table = midiEvents;
+	std::vector<MidiNoteInfo> notes;
+	notes.reserve(table.size());
+	for (ulongint i=0; i<table.size(); i++) {
+		if (!table[i].attack) {
 			continue;
 		}
-		HoleInfo* hi = holes[i];
-		key = hi->midikey;
+		notes.push_back(table[i]);
+		MidiNoteInfo& ni = notes.back();
 
 		if (hasExpressionRegions) {
-			if (key < m_bassNotesTrackStartMidi) { // Bass expression
-				track    = m_bass_exp_track;
-				channel  = m_bass_exp_ch;
-				velocity = velocityquiet; // very quiet, but channel volume will be set to 0
-			} else if (key < m_trebleNotesTrackStartMidi) { // Bass register
-				track    = m_bass_track;
-				channel  = m_bass_ch;
-				velocity = velocitynormal; // mf for now; will be refined by expression rendering later
-			} else if (key < m_trebleExpressionTrackStartMidi) {  // Treble register
-				track    = m_treble_track;
-				channel  = m_treble_ch;
-				velocity = 64;  // mf for now; will be refined by expression rendering later
-			} else { // Treble expression
-				track    = m_treble_exp_track;
-				channel  = m_treble_exp_ch;
-				velocity = velocityquiet; // very quiet, and channel volume will be set to 0
-			}
+			// very quiet expression notes, but channel volume will be set to 0
+			ni.velocity = ni.expression ? velocityquiet : velocitynormal;
 		} else {
 			// No expression, so use default values assuming a regular note.
-			track = m_bass_track;
-			channel = m_bass_ch;
-			velocity = velocitynormal;
+			ni.track    = m_bass_track;
+			ni.channel  = m_bass_ch;
+			ni.velocity = velocitynormal;
 		}
 
 		// Skip likely spurious holes appearing before the first music hole.
-		int ontick = hi->origin.first - mintime;
-		int offtick = hi->offtime - mintime;
+		int ontick = ni.ontick - mintime;
+		int offtick = ni.endtick - mintime;
 
 		if ((ontick < 0) || (offtick < 0)) {
-			cerr << "NOTE ON TICK OR OFF TICK LESS THAN ZERO: " << ontick << " -> " << offtick << " FOR KEY " << hi->midikey << ", SKIPPING" << endl;
+			cerr << "NOTE ON TICK OR OFF TICK LESS THAN ZERO: " << ontick << " -> " << offtick << " FOR KEY " << ni.key << ", SKIPPING" << endl;
+			notes.pop_back();
 			continue;
 		}
 
-		midifile.addNoteOn(track, ontick, channel, hi->midikey, velocity);
-		midifile.addNoteOff(track, offtick, channel, hi->midikey);
+		ni.ontick  = ontick;
+		ni.offtick = offtick;
 
-		if (hi->offtime > maxtime) {
-			maxtime = hi->offtime;
+		if (table[i].endtick > (long)maxtime) {
+			maxtime = table[i].endtick;
 		}
 	}
+	addSortedNotes(midifile, notes);
 
+	// Track 0 only contains metadata and tempo events which are added in
+	// time order, so the tracks do not need to be sorted.
 	if (!m_emulateAcceleration) {
 		midifile.addTempo(0, 0, 60);
-		midifile.sortTracks();
 		return;
 	}
 
@@ -4778,8 +6482,120 @@ void RollImage::generateMidifile(MidiFile& midifile) {
 		currentSpeed = initialSpeed + currentMinute * accelFactor;
 		currentTempo = currentSpeed * ticksPerFoot / tpq;
 	}
+}
+#endif
+
+
+
+//////////////////////////////
+//
+// RollImage::buildMidiEventTable -- Store the MIDI track, channel, key,
+//    velocity and timing of each hole in midiEvents, so that the note and
+//    hole MIDI files (and any other exporter) can be rendered without
+//    repeating the analysis.  Ticks are the pixel rows of the holes in the
+//    image.  The table is built on first use after holes are grouped into
+//    notes and MIDI key numbers are assigned to holes (both of which clear
+//    the table), and it is then shared by all later MIDI file renderings.
+//
+
+void RollImage::buildMidiEventTable(void) {
+	if (!midiEvents.empty()) {
+		return;
+	}
+	midiEvents.resize(holes.size());
+
+	for (ulongint i=0; i<holes.size(); i++) {
+		HoleInfo* hi = holes[i];
+		MidiNoteInfo& ni = midiEvents[i];
+		int key = hi->midikey;
+
+		// estimate the location of the expression tracks and the
+		// bass/treble register split (refine later):
+		if (key < m_bassNotesTrackStartMidi) { // Bass expression
+			ni.track      = m_bass_exp_track;
+			ni.channel    = m_bass_exp_ch;
+			ni.velocity   = 32; // quiet
+			ni.expression = true;
+		} else if (key < m_trebleNotesTrackStartMidi) { // Bass register
+			ni.track    = m_bass_track;
+			ni.channel  = m_bass_ch;
+			ni.velocity = 64; // mf for now; will be refined by expression rendering later
+			ni.velocity += hi->attack ? 32 : -16;
+		} else if (key < m_trebleExpressionTrackStartMidi) {  // Treble register
+			ni.track    = m_treble_track;
+			ni.channel  = m_treble_ch;
+			ni.velocity = 64;  // mf for now; will be refined by expression rendering later
+			ni.velocity += hi->attack ? 32 : -16;
+		} else { // Treble expression
+			ni.track      = m_treble_exp_track;
+			ni.channel    = m_treble_exp_ch;
+			ni.velocity   = 32; // quiet
+			ni.expression = true;
+		}
+
+		ni.key     = key;
+		ni.ontick  = hi->origin.first;
+		ni.offtick = hi->origin.first + hi->width.first;
+		ni.endtick = hi->offtime;
+		ni.attack  = hi->attack;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::addSortedNotes -- Add note-ons and note-offs to the MIDI file
+//    in time order within each track, so that the tracks do not need to be
+//    sorted afterwards.  The notes are visited in onset order (they are only
+//    sorted if not already in order), and the pending note-offs for each
+//    track are kept in a heap.  At equal ticks, note-offs are placed before
+//    note-ons (the same as MidiFile::sortTracks()).  Events which are already
+//    in the tracks must not occur after the first note.
+//
+
+#ifndef DONOTUSEFFT
+void RollImage::addSortedNotes(MidiFile& midifile, std::vector<MidiNoteInfo>& notes) {
+	std::vector<MidiNoteInfo*> list(notes.size());
+	for (ulongint i=0; i<notes.size(); i++) {
+		list[i] = &notes[i];
+	}
+
+	auto byOnset = [](MidiNoteInfo* a, MidiNoteInfo* b) -> bool {
+		return a->ontick < b->ontick;
+	};
+	if (!std::is_sorted(list.begin(), list.end(), byOnset)) {
+		std::stable_sort(list.begin(), list.end(), byOnset);
+	}
+
+	auto laterOff = [](MidiNoteInfo* a, MidiNoteInfo* b) -> bool {
+		return a->offtick > b->offtick;
+	};
+	std::vector<std::vector<MidiNoteInfo*> > pending(midifile.getTrackCount());
+
+	for (ulongint i=0; i<list.size(); i++) {
+		MidiNoteInfo* ni = list[i];
+		std::vector<MidiNoteInfo*>& heap = pending.at(ni->track);
+		while (!heap.empty() && (heap.front()->offtick <= ni->ontick)) {
+			MidiNoteInfo* off = heap.front();
+			midifile.addNoteOff(off->track, off->offtick, off->channel, off->key);
+			std::pop_heap(heap.begin(), heap.end(), laterOff);
+			heap.pop_back();
+		}
+		midifile.addNoteOn(ni->track, ni->ontick, ni->channel, ni->key, ni->velocity);
+		heap.push_back(ni);
+		std::push_heap(heap.begin(), heap.end(), laterOff);
+	}
 
-	midifile.sortTracks();
+	for (ulongint t=0; t<pending.size(); t++) {
+		std::vector<MidiNoteInfo*>& heap = pending[t];
+		while (!heap.empty()) {
+			MidiNoteInfo* off = heap.front();
+			midifile.addNoteOff(off->track, off->offtick, off->channel, off->key);
+			std::pop_heap(heap.begin(), heap.end(), laterOff);
+			heap.pop_back();
+		}
+	}
 }
 #endif
 
@@ -4787,7 +6603,10 @@ void RollImage::generateMidifile(MidiFile& midifile) {
 
 //////////////////////////////
 //
-// RollImage::printQualityReport --
+// RollImage::printQualityReport -- Print an error for each quality check
+//    which fails (too many or too large shifts, and dusty margins).  Only
+//    the shifts and dust score are needed, so this can be called after
+//    analyzeQuality() rather than the full analyze().
 //    default value: out = cerr
 //
 
@@ -4800,9 +6619,11 @@ std::ostream& RollImage::printQualityReport(std::ostream& out) {
 		out << "Error: Too many shifts (" << shifts.size() << ")."
 		    << " Maximum allowed is 19." << endl;
 	}
-	sortShiftsByAmount();
 	if (!shifts.empty()) {
-		double maxshift = std::fabs(shifts[0]->score);
+		double maxshift = 0.0;
+		for (ulongint i=0; i<shifts.size(); i++) {
+			maxshift = std::max(maxshift, std::fabs(shifts[i]->score));
+		}
 		if (maxshift > 15.0) {
 			out << "Error: Too large of a shift detected (" << maxshift << ")."
 			    << " Maximum allowed is 15 pixels." << endl;
@@ -4810,8 +6631,11 @@ std::ostream& RollImage::printQualityReport(std::ostream& out) {
 	}
 	int dustscore = int(getDustScore() + 0.5);
 	if (dustscore > 1000) {
-		out << "Error: margins are too dusty (" << dustscore << ")"
-		    << " Maximum allowed is 1000 ppm." << endl;
+		out << "Error: margins are too dusty (" << dustscore;
+		if (m_dustSampleStep > 1) {
+			out << " +/- " << int(getDustScoreError() + 0.5);
+		}
+		out << ")" << " Maximum allowed is 1000 ppm." << endl;
 	}
 
 	return out;
@@ -4821,48 +6645,47 @@ std::ostream& RollImage::printQualityReport(std::ostream& out) {
 
 //////////////////////////////
 //
-// RollImage::insertRollImageProperties -- see printRollImageProperties().
+// RollImage::getRollSummary -- Return the summary statistics of the roll
+//    which are used in the analysis report, in the MIDI file metadata and
+//    in the quality report.  The summary is calculated on the first call
+//    after analyze() and reused for later calls.
 //
 
-void RollImage::insertRollImageProperties(MidiFile& midifile) {
+RollSummary& RollImage::getRollSummary(void) {
+	RollSummary& summary = m_summary;
+	if (summary.valid) {
+		return summary;
+	}
 	if (!m_analyzedLeaders) {
 		analyzeLeaders();
 	}
 
-	double averageRollWidth = getAverageRollWidth();
-	averageRollWidth = int(averageRollWidth*100.0+0.5)/100.0;
-	double averageSoftMarginWidth = getAverageSoftMarginTotal();
-	averageSoftMarginWidth = int(averageSoftMarginWidth*100.0+0.5)/100.0;
-
-	int musiclength = getLastMusicHoleEnd() - getFirstMusicHoleStart();
-
-	double avgholewidth = int(getAverageMusicalHoleWidth()*100.0+0.5)/100.0;
-
-	double leftCol = m_firstHolePosition - driftCorrection.at(getFirstMusicHoleStart());
-	leftCol = leftCol - leftMarginIndex.at(getFirstMusicHoleStart());
+	summary.rollwidth = int(getAverageRollWidth()*100.0+0.5)/100.0;
+	summary.softmarginsum = int(getAverageSoftMarginTotal()*100.0+0.5)/100.0;
+	summary.bassdriftmax = getSoftMarginLeftWidthMax();
+	summary.trebledriftmax = getSoftMarginRightWidthMax();
 
-	double rightCol = m_lastHolePosition - driftCorrection.at(getFirstMusicHoleStart());
-	rightCol = rightMarginIndex.at(getFirstMusicHoleStart()) - rightCol;
+	summary.musiclength = getLastMusicHoleEnd() - getFirstMusicHoleStart();
+	summary.holewidth = int(getAverageMusicalHoleWidth()*100.0+0.5)/100.0;
 
 	int trackerholes = getExpectedTrackerHoleCount();
-	string trackerstring;
 	if (!trackerholes) {
 		trackerholes = getMeasuredTrackerHoleCount();
-		trackerstring = my_to_string(trackerholes) + " (estimate)";
+		summary.trackerstring = my_to_string(trackerholes) + " (estimate)";
 	} else {
-		trackerstring = my_to_string(trackerholes);
+		summary.trackerstring = my_to_string(trackerholes);
 	}
+	summary.trackerholes = trackerholes;
 
-	ulongint musicnotecount = 0;
+	summary.notecount = 0;
 	for (ulongint i=0; i<holes.size(); i++) {
 		if (holes.at(i)->attack) {
-			musicnotecount++;
+			summary.notecount++;
 		}
 	}
 
-	double driftmax = driftCorrection.at(getFirstMusicHoleStart());;
-	double driftmin = driftCorrection.at(getFirstMusicHoleStart());;
-
+	double driftmax = driftCorrection.at(getFirstMusicHoleStart());
+	double driftmin = driftCorrection.at(getFirstMusicHoleStart());
 	for (ulongint i=getFirstMusicHoleStart()+1; i<getLastMusicHoleEnd(); i++) {
 		double drift = driftCorrection.at(i);
 		if (driftmax < drift) {
@@ -4872,7 +6695,41 @@ void RollImage::insertRollImageProperties(MidiFile& midifile) {
 			driftmin = drift;
 		}
 	}
-	double driftrange = driftmax - driftmin;
+	summary.driftmax = driftmax;
+	summary.driftmin = driftmin;
+	summary.driftrange = driftmax - driftmin;
+
+	summary.dustscore = getDustScore();
+	summary.dustscorebass = getDustScoreBass();
+	summary.dustscoretreble = getDustScoreTreble();
+	summary.dustscoreerror = getDustScoreError();
+
+	summary.maxshift = 0.0;
+	for (ulongint i=0; i<shifts.size(); i++) {
+		if (std::fabs(shifts[i]->score) > summary.maxshift) {
+			summary.maxshift = std::fabs(shifts[i]->score);
+		}
+	}
+
+	summary.md5sum = getDataMD5Sum();
+
+	summary.valid = true;
+	return summary;
+}
+
+
+
+//////////////////////////////
+//
+// RollImage::insertRollImageProperties -- see printRollImageProperties().
+//
+
+void RollImage::insertRollImageProperties(MidiFile& midifile) {
+	if (!m_analyzedLeaders) {
+		analyzeLeaders();
+	}
+
+	RollSummary& summary = getRollSummary();
 
 #ifndef DONOTUSEFFT
 	std::chrono::duration<double> processing_time = stop_time - start_time;
@@ -4893,23 +6750,23 @@ void RollImage::insertRollImageProperties(MidiFile& midifile) {
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@IMAGE_LENGTH:\t"        << getRows();
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@ROLL_WIDTH:\t"          << averageRollWidth;
+	ss << "@ROLL_WIDTH:\t"          << summary.rollwidth;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@HARD_MARGIN_BASS:\t"    << getHardMarginLeftWidth();
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@HARD_MARGIN_TREBLE:\t"  << getHardMarginRightWidth();
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@MAX_BASS_DRIFT:\t"      << getSoftMarginLeftWidthMax();
+	ss << "@MAX_BASS_DRIFT:\t"      << summary.bassdriftmax;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@MAX_TREBLE_DRIFT:\t"    << getSoftMarginRightWidthMax();
+	ss << "@MAX_TREBLE_DRIFT:\t"    << summary.trebledriftmax;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@AVG_SOFT_MARGIN_SUM:\t" << averageSoftMarginWidth;
+	ss << "@AVG_SOFT_MARGIN_SUM:\t" << summary.softmarginsum;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DRIFT_RANGE:\t"         << int(driftrange*100+0.5)/100.0;
+	ss << "@DRIFT_RANGE:\t"         << int(summary.driftrange*100+0.5)/100.0;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DRIFT_MIN:\t"           << int(driftmax*100+0.5)/100.0;
+	ss << "@DRIFT_MIN:\t"           << int(summary.driftmax*100+0.5)/100.0;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DRIFT_MAX:\t"           << int(driftmin*100+0.5)/100.0;
+	ss << "@DRIFT_MAX:\t"           << int(summary.driftmin*100+0.5)/100.0;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@PRELEADER_ROW:\t"       << getPreleaderIndex();
 	midifile.addText(0, 0, ss.str()); ss.str("");
@@ -4921,13 +6778,13 @@ void RollImage::insertRollImageProperties(MidiFile& midifile) {
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@END_MARGIN:\t"          << getRows() - getLastMusicHoleEnd();
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@MUSICAL_LENGTH:\t"      << musiclength;
+	ss << "@MUSICAL_LENGTH:\t"      << summary.musiclength;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@MUSICAL_HOLES:\t"       << holes.size();
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@MUSICAL_NOTES:\t"       << musicnotecount;
+	ss << "@MUSICAL_NOTES:\t"       << summary.notecount;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@AVG_HOLE_WIDTH:\t"      << avgholewidth;
+	ss << "@AVG_HOLE_WIDTH:\t"      << summary.holewidth;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@ANTIDUST_COUNT:\t"      << antidust.size();
 	midifile.addText(0, 0, ss.str()); ss.str("");
@@ -4939,19 +6796,25 @@ void RollImage::insertRollImageProperties(MidiFile& midifile) {
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@TREBLE_TEAR_COUNT:\t"   << trebleTears.size();
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DUST_SCORE:\t"          << int(getDustScore()+0.5) << " ppm";
+	ss << "@DUST_SCORE:\t"          << int(summary.dustscore+0.5) << " ppm";
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DUST_SCORE_BASS:\t"     << int(getDustScoreBass()+0.5) << " ppm";
+	ss << "@DUST_SCORE_BASS:\t"     << int(summary.dustscorebass+0.5) << " ppm";
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@DUST_SCORE_TREBLE:\t"   << int(getDustScoreTreble()+0.5) << " ppm";
+	ss << "@DUST_SCORE_TREBLE:\t"   << int(summary.dustscoretreble+0.5) << " ppm";
 	midifile.addText(0, 0, ss.str()); ss.str("");
+	if (m_dustSampleStep > 1) {
+		ss << "@DUST_SAMPLE_STEP:\t"    << m_dustSampleStep;
+		midifile.addText(0, 0, ss.str()); ss.str("");
+		ss << "@DUST_SCORE_CI95:\t"     << int(summary.dustscoreerror+0.5) << " ppm";
+		midifile.addText(0, 0, ss.str()); ss.str("");
+	}
 	ss << "@SHIFTS:\t"              << shifts.size();
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@HOLE_SEPARATION:\t"     << holeSeparation;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@HOLE_OFFSET:\t"         << holeOffset;
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@TRACKER_HOLES:\t"       << trackerholes;
+	ss << "@TRACKER_HOLES:\t"       << summary.trackerholes;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@HOLE_SOFTWARE:\t"       << "https://github.com/pianoroll/roll-image-parser";
 	midifile.addText(0, 0, ss.str()); ss.str("");
@@ -4974,7 +6837,7 @@ void RollImage::insertRollImageProperties(MidiFile& midifile) {
 #endif
 	ss << "@COLOR_CHANNEL:\t"       << "green";
 	midifile.addText(0, 0, ss.str()); ss.str("");
-	ss << "@CHANNEL_MD5:\t"         << getDataMD5Sum();
+	ss << "@CHANNEL_MD5:\t"         << summary.md5sum;
 	midifile.addText(0, 0, ss.str()); ss.str("");
 	ss << "@BRIDGE_FACTOR:\t"       << getBridgeFactor();
 	midifile.addText(0, 0, ss.str()); ss.str("");
@@ -4995,50 +6858,7 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 		analyzeLeaders();
 	}
 
-	double averageRollWidth = getAverageRollWidth();
-	averageRollWidth = int(averageRollWidth*100.0+0.5)/100.0;
-	double averageSoftMarginWidth = getAverageSoftMarginTotal();
-	averageSoftMarginWidth = int(averageSoftMarginWidth*100.0+0.5)/100.0;
-
-	int musiclength = getLastMusicHoleEnd() - getFirstMusicHoleStart();
-
-	double avgholewidth = int(getAverageMusicalHoleWidth()*100.0+0.5)/100.0;
-
-	double leftCol = m_firstHolePosition - driftCorrection.at(getFirstMusicHoleStart());
-	leftCol = leftCol - leftMarginIndex.at(getFirstMusicHoleStart());
-
-	double rightCol = m_lastHolePosition - driftCorrection.at(getFirstMusicHoleStart());
-	rightCol = rightMarginIndex.at(getFirstMusicHoleStart()) - rightCol;
-
-	int trackerholes = getExpectedTrackerHoleCount();
-	string trackerstring;
-	if (!trackerholes) {
-		trackerholes = getMeasuredTrackerHoleCount();
-		trackerstring = my_to_string(trackerholes) + " (estimate)";
-	} else {
-		trackerstring = my_to_string(trackerholes);
-	}
-
-	ulongint musicnotecount = 0;
-	for (ulongint i=0; i<holes.size(); i++) {
-		if (holes.at(i)->attack) {
-			musicnotecount++;
-		}
-	}
-
-	double driftmax = driftCorrection.at(getFirstMusicHoleStart());;
-	double driftmin = driftCorrection.at(getFirstMusicHoleStart());;
-
-	for (ulongint i=getFirstMusicHoleStart()+1; i<getLastMusicHoleEnd(); i++) {
-		double drift = driftCorrection.at(i);
-		if (driftmax < drift) {
-			driftmax = drift;
-		}
-		if (driftmin > drift) {
-			driftmin = drift;
-		}
-	}
-	double driftrange = driftmax - driftmin;
+	RollSummary& summary = getRollSummary();
 
 #ifndef DONOTUSEFFT
 	std::chrono::duration<double> processing_time = stop_time - start_time;
@@ -5060,9 +6880,19 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 	out << "@@ DRUID:\t\t"             << "Stanford Libraries Dig. Rep. Unique ID" << std::endl;
 	out << "@@ ROLL_TYPE:\t\t"         << "Brand/format of the piano roll" << std::endl;
 	out << "@@ THRESHOLD:\t\t"         << "Threshold byte value for non-paper boundary" << std::endl;
+	out << "@@ THRESHOLD_METHOD:\t"   << "Only given when THRESHOLD was chosen automatically from" << std::endl;
+	out << "@@ \t\t\tthe image (\"otsu\": between paper and backlight brightness)." << std::endl;
 	out << "@@ LENGTH_DPI:\t\t"        << "Scan DPI resolution along the length of the roll" << std::endl;
 	out << "@@ IMAGE_WIDTH:\t\t"       << "Width of the input image in pixels." << std::endl;
 	out << "@@ IMAGE_LENGTH:\t"        << "Length of the input image in pixels." << std::endl;
+	out << "@@ IMAGE_ORIENTATION:\t"   << "Only given when rows are reversed (leader at the bottom of the" << std::endl;
+	out << "@@ \t\t\timage) or columns are mirrored.  Rows and columns in this" << std::endl;
+	out << "@@ \t\t\tanalysis are then measured from the leader and the bass edge." << std::endl;
+	out << "@@ IMAGE_SEGMENTS:\t"     << "Only given when the image is stitched from several scans" << std::endl;
+	out << "@@ \t\t\t(see the SEGMENTS list at the end of the file)." << std::endl;
+	out << "@@ IMAGE_ROW_RANGE:\t"    << "Only given when part of the image was analyzed: the first" << std::endl;
+	out << "@@ \t\t\tand last input image rows of the part.  IMAGE_LENGTH and" << std::endl;
+	out << "@@ \t\t\tthe other rows in this analysis are then within the part." << std::endl;
 	out << "@@ ROLL_WIDTH:\t\t"        << "Measured average width of the piano-roll in pixels." << std::endl;
 	out << "@@ HARD_MARGIN_BASS:\t"    << "Pixel width of the margin on the bass side of the roll" << endl;
 	out << "@@ \t\t\twhere the roll paper never enters." << std::endl;
@@ -5102,8 +6932,18 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 	out << "@@ \t\t\tof parts per million." << std::endl;
 	out << "@@ DUST_SCORE_BASS:\t"     << "Dust particle count in bass register margin." << std::endl;
 	out << "@@ DUST_SCORE_TREBLE:\t"   << "Dust particle count in bass register margin." << std::endl;
+	out << "@@ DUST_SAMPLE_STEP:\t"    << "Only given when the dust was counted in every Nth row" << std::endl;
+	out << "@@ \t\t\tof the margins rather than in all rows." << std::endl;
+	out << "@@ DUST_SCORE_CI95:\t"     << "Half-width of the 95% confidence interval of DUST_SCORE" << std::endl;
+	out << "@@ \t\t\twhen the dust was counted in a sample of rows." << std::endl;
 	out << "@@ SHIFTS:\t\t"            << "Number of automatically detected operator shifts greater" << std::endl;
 	out << "@@ \t\t\tthan 1/100th of an inch over 1/3 of an inch." << std::endl;
+	out << "@@ DUPLICATE_FRAMES:\t"   << "Only given when checking for duplicate frames: the number" << std::endl;
+	out << "@@ \t\t\tof runs of rows which repeat earlier rows (scanner stalls)." << std::endl;
+	out << "@@ DUPLICATE_ROWS:\t"     << "Total number of repeated rows in the duplicate frames." << std::endl;
+	out << "@@ DUPLICATES_REMOVED:\t" << "\"yes\" if the repeated rows were removed before analysis," << std::endl;
+	out << "@@ \t\t\tin which case rows are measured without them, and" << std::endl;
+	out << "@@ \t\t\tIMAGE_ORIGIN_ROW gives the row of a hole in the input image." << std::endl;
 	out << "@@ HOLE_SEPARATION:\t"     << "Distance between muiscal hole centers (i.e., the tracker" << std::endl;
 	out << "@@ \t\t\tbar hole spacings)." << std::endl;
 	out << "@@ HOLE_OFFSET:\t\t"       << "The offset of the tracker bar spacing pattern with respect to" << std::endl;
@@ -5125,39 +6965,68 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 	out << "@DRUID:\t\t\t"           << getDruid()                    << "\n";
 	out << "@ROLL_TYPE:\t\t"         << getRollType()                 << "\n";
 	out << "@THRESHOLD:\t\t"         << getThreshold()                << "\n";
+	if ((m_threshold16 >= 0) && (getBitsPerSample() == 16)) {
+		out << "@THRESHOLD_16BIT:\t"    << m_threshold16                 << "\n";
+	} else if (m_otsuThreshold) {
+		out << "@THRESHOLD_METHOD:\t"   << "otsu"                        << "\n";
+	}
 	out << "@LENGTH_DPI:\t\t"        << getPixelsPerInch()            << "ppi\n";
 	out << "@IMAGE_WIDTH:\t\t"       << getCols()                     << "px\n";
 	out << "@IMAGE_LENGTH:\t\t"      << getRows()                     << "px\n";
-	out << "@ROLL_WIDTH:\t\t"        << averageRollWidth              << "px\n";
+	if (segments.size() > 1) {
+		out << "@IMAGE_SEGMENTS:\t"      << segments.size()               << "\n";
+	}
+	if (m_rowRange) {
+		out << "@IMAGE_ROW_RANGE:\t"     << m_startRow << "-" << m_endRow - 1 << "\n";
+	}
+	if (m_reversedRows || m_mirroredCols) {
+		out << "@IMAGE_ORIENTATION:\t";
+		out << (m_reversedRows ? "reversed" : "normal") << " rows, ";
+		out << (m_mirroredCols ? "mirrored" : "normal") << " columns\n";
+	}
+	out << "@ROLL_WIDTH:\t\t"        << summary.rollwidth             << "px\n";
 	out << "@HARD_MARGIN_BASS:\t"    << getHardMarginLeftWidth()      << "px\n";
 	out << "@HARD_MARGIN_TREBLE:\t"  << getHardMarginRightWidth()     << "px\n";
-	out << "@MAX_BASS_DRIFT:\t"      << getSoftMarginLeftWidthMax()   << "px\n";
-	out << "@MAX_TREBLE_DRIFT:\t"    << getSoftMarginRightWidthMax()  << "px\n";
-	out << "@AVG_SOFT_MARGIN_SUM:\t" << averageSoftMarginWidth        << "px\n";
-	out << "@DRIFT_RANGE:\t\t"       << int(driftrange*100+0.5)/100.0 << "px\n";
-	out << "@DRIFT_MIN:\t\t"         << int(driftmax*100+0.5)/100.0   << "px\n";
-	out << "@DRIFT_MAX:\t\t"         << int(driftmin*100+0.5)/100.0   << "px\n";
+	out << "@MAX_BASS_DRIFT:\t"      << summary.bassdriftmax          << "px\n";
+	out << "@MAX_TREBLE_DRIFT:\t"    << summary.trebledriftmax        << "px\n";
+	out << "@AVG_SOFT_MARGIN_SUM:\t" << summary.softmarginsum         << "px\n";
+	out << "@DRIFT_RANGE:\t\t"       << int(summary.driftrange*100+0.5)/100.0 << "px\n";
+	out << "@DRIFT_MIN:\t\t"         << int(summary.driftmax*100+0.5)/100.0 << "px\n";
+	out << "@DRIFT_MAX:\t\t"         << int(summary.driftmin*100+0.5)/100.0 << "px\n";
 	out << "@PRELEADER_ROW:\t\t"     << getPreleaderIndex()           << "px\n";
 	out << "@LEADER_ROW:\t\t"        << getLeaderIndex()              << "px\n";
 	out << "@FIRST_HOLE:\t\t"        << getFirstMusicHoleStart()      << "px\n";
 	out << "@LAST_HOLE:\t\t"         << getLastMusicHoleEnd()         << "px\n";
 	out << "@END_MARGIN:\t\t"        << getRows() - getLastMusicHoleEnd() << "px\n";
-	out << "@MUSICAL_LENGTH:\t"      << musiclength                   << "px\n";
+	out << "@MUSICAL_LENGTH:\t"      << summary.musiclength           << "px\n";
 	out << "@MUSICAL_HOLES:\t\t"     << holes.size()                  << "\n";
-	out << "@MUSICAL_NOTES:\t\t"     << musicnotecount                << "\n";
-	out << "@AVG_HOLE_WIDTH:\t"      << avgholewidth                  << "px\n";
+	out << "@MUSICAL_NOTES:\t\t"     << summary.notecount             << "\n";
+	out << "@AVG_HOLE_WIDTH:\t"      << summary.holewidth             << "px\n";
 	out << "@ANTIDUST_COUNT:\t"      << antidust.size()               << "\n";
 	out << "@BAD_HOLE_COUNT:\t"      << badHoles.size()               << "\n";
 	out << "@EDGE_TEAR_COUNT:\t"     << trebleTears.size() + bassTears.size() << "\n";
 	out << "@BASS_TEAR_COUNT:\t"     << bassTears.size()              << "\n";
 	out << "@TREBLE_TEAR_COUNT:\t"   << trebleTears.size()            << "\n";
-	out << "@DUST_SCORE:\t\t"        << int(getDustScore()+0.5)       << "ppm\n";
-	out << "@DUST_SCORE_BASS:\t"     << int(getDustScoreBass()+0.5)   << "ppm\n";
-	out << "@DUST_SCORE_TREBLE:\t"   << int(getDustScoreTreble()+0.5) << "ppm\n";
+	out << "@DUST_SCORE:\t\t"        << int(summary.dustscore+0.5)       << "ppm\n";
+	out << "@DUST_SCORE_BASS:\t"     << int(summary.dustscorebass+0.5)   << "ppm\n";
+	out << "@DUST_SCORE_TREBLE:\t"   << int(summary.dustscoretreble+0.5) << "ppm\n";
+	if (m_dustSampleStep > 1) {
+		out << "@DUST_SAMPLE_STEP:\t"    << m_dustSampleStep                 << "\n";
+		out << "@DUST_SCORE_CI95:\t"     << int(summary.dustscoreerror+0.5)  << "ppm\n";
+	}
 	out << "@SHIFTS:\t\t"            << shifts.size()                 << "\n";
+	if (m_duplicateMode != DUPLICATES_IGNORE) {
+		ulongint duplicaterows = 0;
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			duplicaterows += duplicates[i].rows;
+		}
+		out << "@DUPLICATE_FRAMES:\t"   << duplicates.size()             << "\n";
+		out << "@DUPLICATE_ROWS:\t"     << duplicaterows                 << "px\n";
+		out << "@DUPLICATES_REMOVED:\t" << (m_duplicateMode == DUPLICATES_DROP ? "yes" : "no") << "\n";
+	}
 	out << "@HOLE_SEPARATION:\t"     << holeSeparation                << "px\n";
 	out << "@HOLE_OFFSET:\t\t"       << holeOffset                    << "px\n";
-	out << "@TRACKER_HOLES:\t\t"     << trackerstring                 << "\n";
+	out << "@TRACKER_HOLES:\t\t"     << summary.trackerstring         << "\n";
 	out << "@HOLE_SOFTWARE:\t\t"     << "https://github.com/pianoroll/roll-image-parser" << "\n";
 	out << "@SOFTWARE_DATE:\t\t"     << __DATE__ << " " << __TIME__ << endl;
 #ifndef DONOTUSEFFT
@@ -5165,7 +7034,7 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 	out << "@ANALYSIS_TIME:\t\t"     << int(processing_time.count()*100.0+0.5)/100.0 << "sec" << endl;
 #endif
 	out << "@COLOR_CHANNEL:\t\t"     << "green"                       << endl;
-	out << "@CHANNEL_MD5:\t\t"       << getDataMD5Sum()               << endl;
+	out << "@CHANNEL_MD5:\t\t"       << summary.md5sum                << endl;
 	out << "@BRIDGE_FACTOR:\t\t"     << getBridgeFactor()             << endl;
 	out << "@MANUAL_EDITS:\t\t"      << "no"                          << endl;
 
@@ -5196,6 +7065,11 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 	out << "@@ \t\t\tthe same correction value, then the following two parameters are given instead:\n";
 	out << "@@ \t\t\t   HPIXCOR_LEAD:\tHorizontal pixel correction of the hole's leading edge.\n";
 	out << "@@ \t\t\t   HPIXCOR_TRAIL:\tHorizontal pixel correction of the hole's trailing edge.\n";
+	out << "@@ IMAGE_ORIGIN_ROW:\tThe ORIGIN_ROW/ORIGIN_COL of the hole's bounding box as the" << std::endl;
+	out << "@@ IMAGE_ORIGIN_COL:\ttop left pixel in the input image (only when the image has" << std::endl;
+	out << "@@ \t\t\tits leader at the bottom, is mirrored, has had duplicate frames" << std::endl;
+	out << "@@ \t\t\tremoved or only a range of rows was analyzed; see IMAGE_ORIENTATION," << std::endl;
+	out << "@@ \t\t\tDUPLICATES_REMOVED and IMAGE_ROW_RANGE).\n";
 	out << "@@\n";
 	out << "\n";
 
@@ -5333,20 +7207,118 @@ std::ostream& RollImage::printRollImageProperties(std::ostream& out) {
 		out << "@@END: SHIFTS\n";
 	}
 
-	out << "\n@@BEGIN: MIDIFILES\n\n";
+	if (segments.size() > 1) {
+		out << "\n\n";
+		out << "@@\n";
+		out << "@@ The image was stitched from the following segments (files or pages\n";
+		out << "@@ of files) of the scan.  Segment parameters are:\n";
+		out << "@@    FILE: the file containing the segment.\n";
+		out << "@@    PAGE: the image in the file (0 for the first).\n";
+		out << "@@    START_ROW: the first row of the segment in the stitched image.\n";
+		out << "@@    ROWS: the number of rows used from the segment.\n";
+		out << "@@    OVERLAP_ROWS: rows at the start of the segment which repeat the\n";
+		out << "@@       end of the previous segment and were removed.\n";
+		out << "@@    AMBIGUOUS_OVERLAP: given if the overlap could not be identified\n";
+		out << "@@       (for example, if only blank rows match), so all rows were kept.\n";
+		out << "@@\n";
+		out << "\n@@BEGIN: SEGMENTS\n";
+		out << "\n";
+		for (ulongint i=0; i<segments.size(); i++) {
+			segments[i].printAton(out);
+			out << "\n";
+		}
+		out << "@@END: SEGMENTS\n";
+	}
+
+	if (!duplicates.empty()) {
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			string id = "duplicate";
+			if (i+1 < 100) { id += "0"; }
+			if (i+1 < 10 ) { id += "0"; }
+			id += my_to_string(i+1);
+			duplicates[i].id = id;
+		}
+		out << "\n\n";
+		out << "@@\n";
+		out << "@@ Duplicate frames are runs of rows which repeat earlier rows of the\n";
+		out << "@@ image, most likely caused by the scanner stalling.  Duplicate\n";
+		out << "@@ parameters are:\n";
+		out << "@@    ORIGINAL_ROW: the first row in the input image of the original rows.\n";
+		out << "@@    DUPLICATE_ROW: the first row in the input image of the repeated rows.\n";
+		out << "@@    ROWS: the number of repeated rows.\n";
+		out << "@@\n";
+		out << "\n@@BEGIN: DUPLICATES\n";
+		out << "\n";
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			duplicates[i].printAton(out);
+			out << "\n";
+		}
+		out << "@@END: DUPLICATES\n";
+	}
 
-	out << "@MIDIFILE:\n";
-	stringstream ss;
-	generateNoteMidiFileBinasc(ss);
-	out << ss.str();
-	out << endl;
-
-	ss.str("");
-	out << "\n@HOLE_MIDIFILE:\n";
-	generateHoleMidiFileBinasc(ss);
-	out << ss.str();
-	out << endl;
-	out << "\n@@END: MIDIFILES\n\n";
+	if (m_sweepMax >= m_sweepMin) {
+		// Find the range of thresholds around the analysis threshold
+		// which give the same number of holes:
+		int index = getThreshold() - m_sweepMin;
+		int stablemin = -1;
+		int stablemax = -1;
+		if ((index >= 0) && (index <= m_sweepMax - m_sweepMin)) {
+			stablemin = stablemax = index;
+			while ((stablemin > 0) && (m_sweepHoles[stablemin-1] == m_sweepHoles[index])) {
+				stablemin--;
+			}
+			while ((stablemax < m_sweepMax - m_sweepMin) &&
+					(m_sweepHoles[stablemax+1] == m_sweepHoles[index])) {
+				stablemax++;
+			}
+		}
+		out << "\n\n";
+		out << "@@\n";
+		out << "@@ The threshold sweep lists the holes which would be found on the\n";
+		out << "@@ paper at other paper/hole thresholds (before the holes are checked\n";
+		out << "@@ against the tracker bar).  Sweep parameters are:\n";
+		out << "@@    THRESHOLD: the paper/hole threshold.\n";
+		out << "@@    HOLES: the number of regions larger than 100 pixels.\n";
+		out << "@@    HOLE_AREA: the total area of the holes.\n";
+		out << "@@    DUST: the number of smaller regions.\n";
+		out << "@@ STABLE_MIN and STABLE_MAX give the range of thresholds around the\n";
+		out << "@@ analysis threshold with the same number of holes.\n";
+		out << "@@\n";
+		out << "\n@@BEGIN: THRESHOLD_SWEEP\n";
+		out << "\n";
+		if (stablemin >= 0) {
+			out << "@STABLE_MIN:\t" << stablemin + m_sweepMin << "\n";
+			out << "@STABLE_MAX:\t" << stablemax + m_sweepMin << "\n";
+			out << "\n";
+		}
+		for (int t=m_sweepMin; t<=m_sweepMax; t++) {
+			out << "@@BEGIN: SWEEP\n";
+			out << "@THRESHOLD:\t" << t                          << "\n";
+			out << "@HOLES:\t\t"   << m_sweepHoles[t - m_sweepMin] << "\n";
+			out << "@HOLE_AREA:\t" << m_sweepArea[t - m_sweepMin]  << "px\n";
+			out << "@DUST:\t\t"    << m_sweepDust[t - m_sweepMin]  << "\n";
+			out << "@@END: SWEEP\n";
+			out << "\n";
+		}
+		out << "@@END: THRESHOLD_SWEEP\n";
+	}
+
+	if (m_embedMidiFiles) {
+		out << "\n@@BEGIN: MIDIFILES\n\n";
+
+		out << "@MIDIFILE:\n";
+		stringstream ss;
+		generateNoteMidiFileBinasc(ss);
+		out << ss.str();
+		out << endl;
+
+		ss.str("");
+		out << "\n@HOLE_MIDIFILE:\n";
+		generateHoleMidiFileBinasc(ss);
+		out << ss.str();
+		out << endl;
+		out << "\n@@END: MIDIFILES\n\n";
+	}
 
 	// The following section is for displaying intermediate analysis data, mostly about
 	// the tracker bar position.
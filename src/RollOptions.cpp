@@ -290,6 +290,39 @@ std::string RollOptions::getRollType(void) {
 
 
 
+//////////////////////////////
+//
+// RollOptions::setRollType -- Apply the settings for a roll type given
+//   by name (one of the names returned by getRollType(), or the short
+//   forms "red", "green", "licensee", "ampico-b", "duoart", "65" or "88").
+//   Returns false if the name is not a known roll type.
+//
+
+bool RollOptions::setRollType(const std::string& name) {
+	if ((name == "welte-red") || (name == "red")) {
+		setRollTypeRedWelte();
+	} else if ((name == "welte-green") || (name == "green")) {
+		setRollTypeGreenWelte();
+	} else if ((name == "welte-licensee") || (name == "licensee")) {
+		setRollTypeLicenseeWelte();
+	} else if ((name == "duo-art") || (name == "duoart")) {
+		setRollTypeDuoArt();
+	} else if ((name == "ampico") || (name == "ampico-a")) {
+		setRollTypeAmpico();
+	} else if ((name == "ampico_b") || (name == "ampico-b")) {
+		setRollTypeAmpicoB();
+	} else if ((name == "65-note") || (name == "65")) {
+		setRollType65Note();
+	} else if ((name == "88-note") || (name == "88")) {
+		setRollType88Note();
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+
 //////////////////////////////
 //
 // RollOptions::setRollTypeRedWelte -- Apply settings suitable for Red Welte (T-100) piano rolls.
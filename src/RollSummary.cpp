@@ -0,0 +1,72 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 14:20:18 PDT 2026
+// Last Modified: Mon Oct 19 14:20:22 PDT 2026
+// Filename:      RollSummary.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Summary statistics of an analyzed piano roll.
+//
+
+#include "RollSummary.h"
+
+namespace rip  {
+
+
+//////////////////////////////
+//
+// RollSummary::RollSummary --
+//
+
+RollSummary::RollSummary(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// RollSummary::~RollSummary --
+//
+
+RollSummary::~RollSummary() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// RollSummary::clear --
+//
+
+void RollSummary::clear(void) {
+	valid           = false;
+	rollwidth       = 0.0;
+	softmarginsum   = 0.0;
+	bassdriftmax    = 0;
+	trebledriftmax  = 0;
+	driftmin        = 0.0;
+	driftmax        = 0.0;
+	driftrange      = 0.0;
+	musiclength     = 0;
+	holewidth       = 0.0;
+	notecount       = 0;
+	trackerholes    = 0;
+	dustscore       = 0.0;
+	dustscorebass   = 0.0;
+	dustscoretreble = 0.0;
+	dustscoreerror  = 0.0;
+	maxshift        = 0.0;
+	trackerstring.clear();
+	md5sum.clear();
+}
+
+
+
+} // end rip namespace
+
+
+
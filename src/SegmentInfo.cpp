@@ -0,0 +1,78 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 18:20:44 PDT 2026
+// Last Modified: Mon Oct 19 18:20:44 PDT 2026
+// Filename:      SegmentInfo.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Information about a segment (file or page) of a roll
+//                image which was scanned in several parts.
+//
+
+#include "SegmentInfo.h"
+
+namespace rip  {
+
+
+//////////////////////////////
+//
+// SegmentInfo::SegmentInfo --
+//
+
+SegmentInfo::SegmentInfo(void) {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// SegmentInfo::~SegmentInfo --
+//
+
+SegmentInfo::~SegmentInfo() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// SegmentInfo::clear --
+//
+
+void SegmentInfo::clear(void) {
+	filename.clear();
+	page     = 0;
+	startrow = 0;
+	rows     = 0;
+	overlap  = 0;
+	ambiguous = false;
+}
+
+
+
+//////////////////////////////
+//
+// SegmentInfo::printAton -- print segment information in ATON format.
+//
+
+std::ostream& SegmentInfo::printAton(std::ostream& out) {
+	out << "@@BEGIN: SEGMENT\n";
+	out << "@FILE:\t\t"        << filename << std::endl;
+	out << "@PAGE:\t\t"        << page     << std::endl;
+	out << "@START_ROW:\t"     << startrow << "px" << std::endl;
+	out << "@ROWS:\t\t"        << rows     << "px" << std::endl;
+	out << "@OVERLAP_ROWS:\t"  << overlap  << "px" << std::endl;
+	if (ambiguous) {
+		out << "@AMBIGUOUS_OVERLAP:\tyes" << std::endl;
+	}
+	out << "@@END: SEGMENT\n";
+	return out;
+}
+
+
+
+} // end rip namespace
@@ -17,6 +17,19 @@
 
 
 #include "TiffFile.h"
+#include "MemoryStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 
 using namespace std;
@@ -53,7 +66,18 @@ TiffFile::~TiffFile(void) {
 //
 
 void TiffFile::close(void) {
-	fstream::close();
+	if (is_open()) {
+		fstream::close();
+	}
+	if (m_mapped) {
+		munmap(m_mapped, m_mappedSize);
+		m_mapped = NULL;
+		m_mappedSize = 0;
+	}
+	m_memory = NULL;
+	m_memorySize = 0;
+	m_memoryBuffer.clear();
+	m_memoryBuffer.shrink_to_fit();
 	TiffHeader::clear();
 }
 
@@ -65,7 +89,7 @@ void TiffFile::close(void) {
 //
 
 bool TiffFile::open(const string& filename) {
-	if (is_open()) {
+	if (is_open() || m_memory) {
 		close();
 	}
 
@@ -81,6 +105,237 @@ bool TiffFile::open(const string& filename) {
 
 
 
+//////////////////////////////
+//
+// TiffFile::openMemory -- Use a TIFF image which is already in memory.
+//     The data is not copied, so it must remain valid until the file is
+//     closed.  The name is used in place of a filename (such as for
+//     extracting the DRUID).  Only image reading is possible with memory
+//     input (not header updates or pixel writing).
+//     default value: name = "";
+//
+
+bool TiffFile::openMemory(const ucharint* data, ulonglongint size, const string& name) {
+	close();
+	return parseMemory(data, size, name);
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::parseMemory -- Parse the header of an image in memory
+//     (which may be owned by this object, so the input is not closed
+//     first).
+//
+
+bool TiffFile::parseMemory(const ucharint* data, ulonglongint size, const string& name) {
+	m_memory = data;
+	m_memorySize = size;
+	m_filename = name;
+
+	MemoryStream input(data, size);
+	if (!parseHeader(input)) {
+		close();
+		return false;
+	}
+	if (!checkMemoryData()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::checkMemoryData -- Check that the image data of the current
+//     page is contained in the input memory.
+//
+
+bool TiffFile::checkMemoryData(void) {
+	ulonglongint size = m_memorySize;
+	ulonglongint databytes = (ulonglongint)getRows() * getCols() * getBytesPerPixel();
+	ulonglongint dataend = getDataOffset() + databytes;
+	if (isPlanar()) {
+		ulonglongint planebytes = databytes / getSamplesPerPixel();
+		dataend = 0;
+		for (int i=0; i<getSamplesPerPixel(); i++) {
+			dataend = std::max(dataend, getPlaneOffset(i) + planebytes);
+		}
+	}
+	if (dataend > size) {
+		cerr << "Image data extends past the end of the input ("
+		     << dataend << " > " << size << " bytes)" << endl;
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::openStream -- Read a TIFF image from a (possibly non-seekable)
+//     stream, such as a pipe, and keep it in memory.
+//     default value: name = "";
+//
+
+bool TiffFile::openStream(istream& input, const string& name) {
+	close();
+	const ulongint chunk = 1 << 24;
+	ulonglongint size = 0;
+	while (input) {
+		m_memoryBuffer.resize(size + chunk);
+		input.read((char*)m_memoryBuffer.data() + size, chunk);
+		size += input.gcount();
+	}
+	m_memoryBuffer.resize(size);
+	if (size == 0) {
+		cerr << "Input stream " << name << " is empty" << endl;
+		return false;
+	}
+	return parseMemory(m_memoryBuffer.data(), size, name);
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::openFileDescriptor -- Read a TIFF image from an open file
+//     descriptor.  Regular files are memory mapped, while pipes are read
+//     into memory.  The file descriptor can be closed afterwards.
+//     default value: name = "";
+//
+
+bool TiffFile::openFileDescriptor(int fd, const string& name) {
+	close();
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		cerr << "Cannot access input file " << name << endl;
+		return false;
+	}
+
+	if (S_ISREG(info.st_mode) && (info.st_size > 0)) {
+		void* mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped != MAP_FAILED) {
+			m_mapped = mapped;
+			m_mappedSize = info.st_size;
+			madvise(m_mapped, m_mappedSize, MADV_SEQUENTIAL);
+			return parseMemory((const ucharint*)m_mapped, m_mappedSize, name);
+		}
+	}
+
+	const ulongint chunk = 1 << 24;
+	ulonglongint size = 0;
+	while (true) {
+		m_memoryBuffer.resize(size + chunk);
+		ssize_t count = ::read(fd, m_memoryBuffer.data() + size, chunk);
+		if (count <= 0) {
+			break;
+		}
+		size += count;
+	}
+	m_memoryBuffer.resize(size);
+	if (size == 0) {
+		cerr << "Input file " << name << " is empty" << endl;
+		return false;
+	}
+	return parseMemory(m_memoryBuffer.data(), size, name);
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::openMapped -- Memory map a TIFF file for reading (read-only).
+//
+
+bool TiffFile::openMapped(const string& filename) {
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cerr << "Input filename " << filename << " cannot be opened" << endl;
+		return false;
+	}
+	bool status = openFileDescriptor(fd, filename);
+	::close(fd);
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::isMemoryInput -- True if the image is read from memory
+//     (see openMemory) rather than from the fstream.
+//
+
+bool TiffFile::isMemoryInput(void) {
+	return m_memory != NULL;
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::openInput -- Open the input of another TiffFile a second time
+//     with a fresh header (such as when the header of the source was
+//     adjusted for analysis).  Memory input is shared rather than copied,
+//     so the source must stay open until this file is closed.
+//
+
+bool TiffFile::openInput(TiffFile& source) {
+	if (source.m_memory) {
+		return openMemory(source.m_memory, source.m_memorySize, source.m_filename);
+	}
+	return open(source.m_filename);
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::getInputSize -- Return the size of the input file (or memory)
+//     in bytes.
+//
+
+ulonglongint TiffFile::getInputSize(void) {
+	if (m_memory) {
+		return m_memorySize;
+	}
+	std::fstream::clear();
+	seekg(0, ios::end);
+	return (ulonglongint)tellg();
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::readBytes -- Copy bytes from the input starting at the given
+//     byte offset.  Returns false if the input is shorter than requested.
+//
+
+bool TiffFile::readBytes(ucharint* buffer, ulonglongint offset, ulonglongint count) {
+	if (count == 0) {
+		return true;
+	}
+	if (m_memory) {
+		if (offset + count > m_memorySize) {
+			return false;
+		}
+		memcpy(buffer, m_memory + offset, count);
+		return true;
+	}
+	std::fstream::clear();
+	goToByteIndex(offset);
+	read((char*)buffer, count);
+	return (ulonglongint)gcount() == count;
+}
+
+
+
 //////////////////////////////
 //
 // TiffFile::goToByteIndex --
@@ -140,11 +395,12 @@ string TiffFile::readString(ulongint count) {
 
 //////////////////////////////
 //
-// TiffFile::readString -- Hard-coded to 24-bit pixels for now.
+// TiffFile::goToPixelIndex -- Go to the first byte of a pixel (see
+//     TiffHeader::getPixelOffset).
 //
 
 bool TiffFile::goToPixelIndex(ulonglongint pindex) {
-	goToByteIndex(this->getDataOffset() + pindex * 3);
+	goToByteIndex(this->getPixelOffset(pindex));
 	return true;
 }
 
@@ -152,12 +408,12 @@ bool TiffFile::goToPixelIndex(ulonglongint pindex) {
 
 //////////////////////////////
 //
-// TiffFile::goToRowColumnIndex -- Hard-coded to 24-bit pixels for now.
+// TiffFile::goToRowColumnIndex -- Go to the first byte of a pixel given
+//     by row and column.
 //
 
 bool TiffFile::goToRowColumnIndex(ulongint rowindex, ulongint colindex) {
-	ulonglongint offset = rowindex * 3 * this->getCols() + colindex * 3;
-	goToByteIndex(this->getDataOffset() + offset);
+	goToByteIndex(this->getPixelOffset(rowindex, colindex));
 	return true;
 }
 
@@ -165,45 +421,217 @@ bool TiffFile::goToRowColumnIndex(ulongint rowindex, ulongint colindex) {
 
 //////////////////////////////
 //
-// TiffFile::getImageGreenChannel --
+// TiffFile::getImageGreenChannel -- Read the green channel of the image
+//     (or the only channel of a monochrome image) as 8-bit samples.  For
+//     16-bit images, a mask can also be filled in with 1 for pixels which
+//     are at or above threshold16 (using all 16 bits) and 0 for pixels below.
+//     default value: mask = NULL
+//     default value: threshold16 = 0
 //
 
-void TiffFile::getImageGreenChannel(vector<vector<ucharint> >& image) {
-	this->goToPixelIndex((int)0);
-	ulongint rows = this->getRows();
+void TiffFile::getImageGreenChannel(vector<vector<ucharint> >& image,
+		vector<vector<ucharint> >* mask, ushortint threshold16) {
+	readImageChannel(image, this->isMonochrome() ? 0 : 1, mask, threshold16,
+			0, this->getRows());
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::getImageChannel -- Read the first channel of the image (the
+//     only channel of a monochrome image) as 8-bit samples.
+//     default value: mask = NULL
+//     default value: threshold16 = 0
+//
+
+void TiffFile::getImageChannel(vector<vector<ucharint> >& image,
+		vector<vector<ucharint> >* mask, ushortint threshold16) {
+	readImageChannel(image, 0, mask, threshold16, 0, this->getRows());
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::readImageChannel -- Read one channel of the image a row at a
+//     time, either from memory or from the fstream.  Only the rows from
+//     startrow up to (but not including) endrow are read, so that a large
+//     image can be processed in blocks.
+//
+
+void TiffFile::readImageChannel(vector<vector<ucharint> >& image, int channel,
+		vector<vector<ucharint> >* mask, ushortint threshold16,
+		ulongint startrow, ulongint endrow) {
+	endrow = std::min(endrow, (ulongint)this->getRows());
+	ulongint rows = endrow > startrow ? endrow - startrow : 0;
 	ulongint cols = this->getCols();
-	vector<ucharint> pixel(3);
+	ulonglongint rowbytes = (ulonglongint)cols * this->getBytesPerPixel();
+	ulonglongint offset = this->getDataOffset();
+	int spp = this->getSamplesPerPixel();
+	if (this->isPlanar()) {
+		// Only read the plane for the channel.
+		rowbytes = (ulonglongint)cols * (this->getBitsPerSample() / 8);
+		offset = this->getPlaneOffset(channel);
+		spp = 1;
+		channel = 0;
+	}
+	offset += (ulonglongint)startrow * rowbytes;
+
+	vector<ucharint> buffer;
+	if (!m_memory) {
+		buffer.resize(rowbytes);
+		this->goToByteIndex(offset);
+	}
+
 	image.resize(rows);
+	if (mask) {
+		mask->resize(rows);
+	}
 	for (ulongint r=0; r<rows; r++) {
-		image.at(r).resize(cols);
-		for (ulongint c=0; c<cols; c++) {
-			pixel[0] = this->read1UByte();  // red
-			pixel[1] = this->read1UByte();  // green
-			pixel[2] = this->read1UByte();  // blue
-			image.at(r).at(c) = pixel[1];
+		const ucharint* data;
+		if (m_memory) {
+			data = m_memory + offset + r * rowbytes;
+		} else {
+			this->read((char*)buffer.data(), rowbytes);
+			ulonglongint count = this->gcount();
+			if (count < rowbytes) {
+				// truncated image
+				std::fill(buffer.begin() + count, buffer.end(), 0);
+			}
+			data = buffer.data();
+		}
+		image[r].resize(cols);
+		ucharint* maskrow = NULL;
+		if (mask) {
+			(*mask)[r].resize(cols);
+			maskrow = (*mask)[r].data();
 		}
+		convertSamples(data, cols, spp, channel, image[r].data(), maskrow, threshold16);
 	}
 }
 
 
 
+#ifdef __SSE2__
+
 //////////////////////////////
 //
-// TiffFile::getImageChannel --
+// gatherGreen48 -- Collect the green samples of eight interleaved 16-bit
+//     RGB pixels (48 bytes) into one vector, keeping the byte order of
+//     the file.  The green samples are words 1, 4 and 7 of the first
+//     vector, words 2 and 5 of the second and words 0, 3 and 6 of the
+//     third.
+//
+
+static inline __m128i gatherGreen48(const ucharint* data) {
+	__m128i a = _mm_loadu_si128((const __m128i*)data);
+	__m128i b = _mm_loadu_si128((const __m128i*)(data + 16));
+	__m128i c = _mm_loadu_si128((const __m128i*)(data + 32));
+
+	const __m128i m0  = _mm_set_epi16(0, 0, 0, 0, 0, 0, 0, -1);
+	const __m128i m12 = _mm_set_epi16(0, 0, 0, 0, 0, -1, -1, 0);
+	const __m128i m34 = _mm_set_epi16(0, 0, 0, -1, -1, 0, 0, 0);
+	const __m128i m56 = _mm_set_epi16(0, -1, -1, 0, 0, 0, 0, 0);
+	const __m128i m7  = _mm_set_epi16(-1, 0, 0, 0, 0, 0, 0, 0);
+
+	// a1 to word 0; a4, a7 to words 1 and 2:
+	__m128i g = _mm_and_si128(_mm_shufflelo_epi16(a, _MM_SHUFFLE(3,3,3,1)), m0);
+	g = _mm_or_si128(g, _mm_and_si128(_mm_srli_si128(
+			_mm_shufflehi_epi16(a, _MM_SHUFFLE(3,3,0,0)), 8), m12));
+	// b2, b5 to words 3 and 4:
+	g = _mm_or_si128(g, _mm_and_si128(_mm_shufflehi_epi16(
+			_mm_shufflelo_epi16(b, _MM_SHUFFLE(2,0,0,0)), _MM_SHUFFLE(3,3,3,1)), m34));
+	// c0, c3 to words 5 and 6; c6 to word 7:
+	g = _mm_or_si128(g, _mm_and_si128(_mm_shufflehi_epi16(
+			_mm_slli_si128(c, 8), _MM_SHUFFLE(0,3,0,0)), m56));
+	g = _mm_or_si128(g, _mm_and_si128(_mm_shufflehi_epi16(c,
+			_MM_SHUFFLE(2,0,0,0)), m7));
+	return g;
+}
+
+#endif
+
+
+
+//////////////////////////////
+//
+// TiffFile::convertSamples -- Extract one channel from a row of pixels,
+//     reducing 16-bit samples to their most significant byte.  The common
+//     cases of 16-bit single-channel rows (monochrome images or planes of
+//     planar images) and the green channel of interleaved 16-bit RGB rows
+//     are converted 16 pixels at a time with SSE2 instructions when
+//     available.
 //
 
-void TiffFile::getImageChannel(vector<vector<ucharint> >& image) {
-	//PMB -- works if monochrome because it's always 0
-	this->goToPixelIndex((int)0);
-	ulongint rows = this->getRows();
-	ulongint cols = this->getCols();
-	ucharint pixel;
-	image.resize(rows);
-	for (ulongint r=0; r<rows; r++) {
-		image.at(r).resize(cols);
-		for (ulongint c=0; c<cols; c++) {
-			pixel = this->read1UByte();
-			image.at(r).at(c) = pixel;
+void TiffFile::convertSamples(const ucharint* data, ulongint count, int spp,
+		int channel, ucharint* output, ucharint* mask, ushortint threshold16) {
+
+	if (this->getBitsPerSample() == 8) {
+		if (spp == 1) {
+			memcpy(output, data, count);
+		} else {
+			for (ulongint c=0; c<count; c++) {
+				output[c] = data[c * spp + channel];
+			}
+		}
+		if (mask) {
+			for (ulongint c=0; c<count; c++) {
+				mask[c] = output[c] * 257 >= threshold16 ? 1 : 0;
+			}
+		}
+		return;
+	}
+
+	int hi = this->isBigEndian() ? 0 : 1;
+	int lo = 1 - hi;
+	ulongint c = 0;
+
+#ifdef __SSE2__
+	if ((spp == 1) && !mask) {
+		const __m128i lowbytes = _mm_set1_epi16(0x00ff);
+		for ( ; c + 16 <= count; c += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(data + c * 2));
+			__m128i b = _mm_loadu_si128((const __m128i*)(data + c * 2 + 16));
+			if (hi == 0) {
+				a = _mm_and_si128(a, lowbytes);
+				b = _mm_and_si128(b, lowbytes);
+			} else {
+				a = _mm_srli_epi16(a, 8);
+				b = _mm_srli_epi16(b, 8);
+			}
+			_mm_storeu_si128((__m128i*)(output + c), _mm_packus_epi16(a, b));
+		}
+	} else if ((spp == 3) && (channel == 1)) {
+		const __m128i threshold = _mm_set1_epi16((short)threshold16);
+		const __m128i one = _mm_set1_epi8(1);
+		for ( ; c + 16 <= count; c += 16) {
+			__m128i a = gatherGreen48(data + c * 6);
+			__m128i b = gatherGreen48(data + c * 6 + 48);
+			if (hi == 0) {
+				// big-endian samples: swap to native order
+				a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+				b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+			}
+			_mm_storeu_si128((__m128i*)(output + c), _mm_packus_epi16(
+					_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+			if (mask) {
+				// sample >= threshold16 when threshold16 - sample saturates to 0
+				__m128i zero = _mm_setzero_si128();
+				__m128i ma = _mm_cmpeq_epi16(_mm_subs_epu16(threshold, a), zero);
+				__m128i mb = _mm_cmpeq_epi16(_mm_subs_epu16(threshold, b), zero);
+				_mm_storeu_si128((__m128i*)(mask + c),
+						_mm_and_si128(_mm_packs_epi16(ma, mb), one));
+			}
+		}
+	}
+#endif
+
+	for ( ; c<count; c++) {
+		const ucharint* sample = data + (c * spp + channel) * 2;
+		output[c] = sample[hi];
+		if (mask) {
+			mask[c] = ((sample[hi] << 8) | sample[lo]) >= threshold16 ? 1 : 0;
 		}
 	}
 }
@@ -232,6 +660,51 @@ void TiffFile::writeDirectoryOffset(ulonglongint offset) {
 
 
 
+//////////////////////////////
+//
+// TiffFile::getPageCount -- Return the number of images (directories)
+//     in the file.
+//
+
+int TiffFile::getPageCount(void) {
+	int output;
+	if (m_memory) {
+		MemoryStream input(m_memory, m_memorySize);
+		output = countPages(input);
+	} else {
+		std::fstream::clear();
+		output = countPages(*this);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// TiffFile::selectPage -- Read the image parameters of a later page in
+//     the file, so that getImageChannel() and related functions access
+//     that image instead.  Page 0 is the first image in the file.
+//
+
+bool TiffFile::selectPage(int page) {
+	bool status;
+	if (m_memory) {
+		MemoryStream input(m_memory, m_memorySize);
+		status = parsePage(input, page);
+		if (status) {
+			status = checkMemoryData();
+		}
+	} else {
+		std::fstream::clear();
+		status = parsePage(*this, page);
+		std::fstream::clear();
+	}
+	return status;
+}
+
+
+
 //////////////////////////////
 //
 // TiffFile::getFilename --
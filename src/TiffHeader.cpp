@@ -77,17 +77,55 @@ void TiffHeader::clear(void) {
 	m_coldpi          = 0.0;
 	m_64bitQ          = false;
 	m_samplesperpixel = 0;
+	m_bitspersample   = 8;
+	m_bigEndian       = false;
+	m_planar          = false;
+	m_planeoffsets.clear();
+	m_subfiletype     = 0;
 
 	m_allowMonochrome = true;
+	m_parseError      = false;
 
 	// clear file offsets:
 	m_samplesperpixel_offset = 0;
+	m_stripoffsets_entry     = 0;
+	m_stripoffsets_type      = 0;
+	m_stripoffsets_count     = 0;
 	m_diroffset              = 0;
 	m_diroffset_offset       = 0;
 }
 
 
 
+//////////////////////////////
+//
+// TiffHeader::clearImageFields -- Reset the parameters which are stored
+//    in an image directory, leaving the file-level parameters (byte order,
+//    BigTIFF and first directory offset) in place so that another
+//    directory (page) can be read.
+//
+
+void TiffHeader::clearImageFields(void) {
+	m_rows            = 0;
+	m_cols            = 0;
+	m_orientation     = -1;
+	m_dataoffset      = 0;
+	m_databytes       = 0;
+	m_samplesperpixel = 0;
+	m_bitspersample   = 8;
+	m_planar          = false;
+	m_planeoffsets.clear();
+	m_subfiletype     = 0;
+	m_parseError      = false;
+
+	m_samplesperpixel_offset = 0;
+	m_stripoffsets_entry     = 0;
+	m_stripoffsets_type      = 0;
+	m_stripoffsets_count     = 0;
+}
+
+
+
 //////////////////////////////
 //
 // TiffHeader::getRows --
@@ -231,6 +269,92 @@ void TiffHeader::setSamplesPerPixel(int value) {
 
 
 
+//////////////////////////////
+//
+// TiffHeader::setBitsPerSample -- 8 or 16.
+//
+
+void TiffHeader::setBitsPerSample(int value) {
+	m_bitspersample = value;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::getBitsPerSample -- Return the number of bits in each
+//     sample (8 or 16).
+//
+
+int TiffHeader::getBitsPerSample(void) const {
+	return m_bitspersample;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::getSamplesPerPixel -- 1 = monochrome, 3 = RGB.
+//
+
+int TiffHeader::getSamplesPerPixel(void) const {
+	return m_samplesperpixel == 1 ? 1 : 3;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::getBytesPerPixel -- Return the number of bytes for each
+//     pixel in the image data.
+//
+
+int TiffHeader::getBytesPerPixel(void) const {
+	return getSamplesPerPixel() * (m_bitspersample / 8);
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::isBigEndian -- True if 16-bit samples are stored with the
+//     most significant byte first.
+//
+
+bool TiffHeader::isBigEndian(void) const {
+	return m_bigEndian;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::isPlanar -- True if each sample is stored in a separate
+//     plane (PlanarConfiguration = 2) rather than interleaved by pixel.
+//
+
+bool TiffHeader::isPlanar(void) const {
+	return m_planar;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::getPlaneOffset -- Return the byte offset of the image data
+//     for the given channel of a planar image, or the start of the image
+//     data for interleaved images.
+//
+
+ulonglongint TiffHeader::getPlaneOffset(int channel) const {
+	if (m_planar && (channel >= 0) && (channel < (int)m_planeoffsets.size())) {
+		return m_planeoffsets[channel];
+	}
+	return getDataOffset();
+}
+
+
+
 //////////////////////////////
 //
 // TiffHeader::getRowDpi --
@@ -280,20 +404,23 @@ void TiffHeader::setColDpi(double value) {
 // TiffHeader::parseHeader -- Presumes that the input is at its beginning.
 //
 
-bool TiffHeader::parseHeader(std::fstream& input) {
+bool TiffHeader::parseHeader(std::istream& input) {
 
-	// Read 2-byte format code.  Required for now to be "II" for little-std::endian.
-   // These are hex bytes "4D 4D".
+	// Read 2-byte format code: "II" for little-endian (hex bytes "49 49")
+	// or "MM" for big-endian (hex bytes "4D 4D").
 	std::string format = readString(input, 2);
-	if (format != "II") {
-		std::cerr << "File format must be little-endian" << std::endl;
-		std::cerr << "Format should be 'II', but is instead '" << format << "'." << std::endl;
+	if (format == "II") {
+		m_bigEndian = false;
+	} else if (format == "MM") {
+		m_bigEndian = true;
+	} else {
+		std::cerr << "Format should be 'II' or 'MM', but is instead '" << format << "'." << std::endl;
 		return false;
 	}
 
 	// Read file-type magic number.  Required to be 0x2A for 32-bit TIFF,
 	// or 0x2B for 64-bit TIFF:
-	ushortint filetype = readLittleEndian2ByteUInt(input);
+	ushortint filetype = read2ByteUInt(input);
 	if (filetype == 0x2A) {
 		// do nothing
 	} else if (filetype == 0x2B) {
@@ -307,30 +434,33 @@ bool TiffHeader::parseHeader(std::fstream& input) {
 	// bigTiff images have two extra parameters: 2-byte count of bytes in offsets
 	// and 2-byte constant 0x0000:
 	if (this->isBigTiff()) {
-		short value = readLittleEndian2ByteUInt(input);
+		short value = read2ByteUInt(input);
 		if (value != 8) {
 			std::cerr << "Strange offset size: " << value << " bytes" << std::endl;
 			return false;
 		}
-		value = readLittleEndian2ByteUInt(input);
+		value = read2ByteUInt(input);
 		// value should now be 0, but actual number is not important.
 	}
 
 	// byte offset of first directory
 	m_diroffset_offset = input.tellg();
 	if (this->isBigTiff()) {
-		m_diroffset = readLittleEndian8ByteUInt(input);
+		m_diroffset = read8ByteUInt(input);
 	} else {
-		m_diroffset = readLittleEndian4ByteUInt(input);
+		m_diroffset = read4ByteUInt(input);
 	}
 
 	bool status = parseDirectory(input, m_diroffset);
+	if (status && m_planar) {
+		status = readPlaneOffsets(input);
+	}
 	if (!status) {
 		clear();
 		return false;
 	}
 
-	ulonglongint expected = (ulonglongint)this->getRows() * (ulonglongint)this->getCols() * 3;
+	ulonglongint expected = (ulonglongint)this->getRows() * (ulonglongint)this->getCols() * this->getBytesPerPixel();
 	if (expected != (ulonglongint)this->getDataBytes()) {
 		std::cerr << "WARNING: image size does not match header information." << std::endl;
 		std::cerr << "STRIP BYTE COUNT " << this->getDataBytes() << std::endl;
@@ -371,7 +501,7 @@ bool TiffHeader::isMonochrome(void) const {
 // TiffHeader::parseDirectory -- Read data parameters for a TIFF directory structure.
 //
 
-bool TiffHeader::parseDirectory(std::fstream& input, ulonglongint diroffset) {
+bool TiffHeader::parseDirectory(std::istream& input, ulonglongint diroffset) {
 	// jump to the header beginning:
 	goToByteIndex(input, diroffset);
 
@@ -379,9 +509,9 @@ bool TiffHeader::parseDirectory(std::fstream& input, ulonglongint diroffset) {
 	// Each entry is 12 bytes long for 32-bit TIFFs and 20 bytes for 64-bt TIFFs
 	ulonglongint entrycount;
 	if (this->isBigTiff()) {
-		entrycount = readLittleEndian8ByteUInt(input);
+		entrycount = read8ByteUInt(input);
 	} else {
-		entrycount = readLittleEndian2ByteUInt(input);
+		entrycount = read2ByteUInt(input);
 	}
 
 	for (ulonglongint i=0; i<entrycount; i++) {
@@ -394,17 +524,107 @@ bool TiffHeader::parseDirectory(std::fstream& input, ulonglongint diroffset) {
 
 
 
+//////////////////////////////
+//
+// TiffHeader::readNextDirectoryOffset -- Return the offset of the directory
+//    following the one at the given offset, or 0 if it is the last one.
+//
+
+ulonglongint TiffHeader::readNextDirectoryOffset(std::istream& input,
+		ulonglongint diroffset) {
+	ulonglongint entrycount;
+	ulonglongint output;
+	goToByteIndex(input, diroffset);
+	if (this->isBigTiff()) {
+		entrycount = read8ByteUInt(input);
+		goToByteIndex(input, diroffset + 8 + entrycount * 20);
+		output = read8ByteUInt(input);
+	} else {
+		entrycount = read2ByteUInt(input);
+		goToByteIndex(input, diroffset + 2 + entrycount * 12);
+		output = read4ByteUInt(input);
+	}
+	if (!input.good()) {
+		input.clear();
+		return 0;
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::countPages -- Return the number of image directories
+//    (pages) in the file.  The header must have been parsed already.
+//
+
+int TiffHeader::countPages(std::istream& input) {
+	int count = 0;
+	ulonglongint offset = m_diroffset;
+	while (offset != 0) {
+		count++;
+		offset = readNextDirectoryOffset(input, offset);
+	}
+	return count;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::parsePage -- Read the image parameters of the given page
+//    (0 for the first directory in the file).  The header must have
+//    been parsed already.
+//
+
+bool TiffHeader::parsePage(std::istream& input, int page) {
+	if (page < 0) {
+		return false;
+	}
+	ulonglongint offset = m_diroffset;
+	for (int i=0; i<page; i++) {
+		offset = readNextDirectoryOffset(input, offset);
+		if (offset == 0) {
+			std::cerr << "Error: page " << page << " does not exist." << std::endl;
+			return false;
+		}
+	}
+
+	clearImageFields();
+	bool status = parseDirectory(input, offset);
+	if (status && m_planar) {
+		status = readPlaneOffsets(input);
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::isReducedImage -- True if the current directory is a
+//    reduced-resolution version of another image in the file (such as
+//    a thumbnail).
+//
+
+bool TiffHeader::isReducedImage(void) const {
+	return (m_subfiletype & 1) ? true : false;
+}
+
+
+
 //////////////////////////////
 //
 // TiffHeader::goToByteIndex --
 //
 
-bool TiffHeader::goToByteIndex(std::fstream& input, ulongint offset) {
+bool TiffHeader::goToByteIndex(std::istream& input, ulongint offset) {
 	input.seekg(offset, input.beg);
 	return true;
 }
 
-bool TiffHeader::goToByteIndex(std::fstream& input, ulonglongint offset) {
+bool TiffHeader::goToByteIndex(std::istream& input, ulonglongint offset) {
 	if (offset <= (ulonglongint)0xffffffff) {
 		input.seekg((ulongint)offset, input.beg);
 	} else {
@@ -428,21 +648,21 @@ bool TiffHeader::goToByteIndex(std::fstream& input, ulonglongint offset) {
 // readDirectoryEntry -- Read header parameters from TIFF image.
 //
 
-bool TiffHeader::readDirectoryEntry(std::fstream& input) {
+bool TiffHeader::readDirectoryEntry(std::istream& input) {
 	ulonglongint entryoffset = input.tellg();
 
 	// get the parameter type (tag)
-	int id = readLittleEndian2ByteUInt(input);
+	int id = read2ByteUInt(input);
 
 	// get the data type
-	int datatype = readLittleEndian2ByteUInt(input);
+	int datatype = read2ByteUInt(input);
 
 	// get number of values in parameter
 	ulonglongint count;
 	if (this->isBigTiff()) {
-		count = readLittleEndian8ByteUInt(input);
+		count = read8ByteUInt(input);
 	} else {
-		count = readLittleEndian4ByteUInt(input);
+		count = read4ByteUInt(input);
 	}
 
 	if (datatype != 2) {
@@ -462,6 +682,7 @@ bool TiffHeader::readDirectoryEntry(std::fstream& input) {
 
 		case 254: // NewSubfileType (added by Adobe Photoshop)
 			value = (ulongint)this->readEntryUInteger(input, datatype, count, id);
+			m_subfiletype = value;
 			switch (value) {
 				case 0: /* Adobe just puts an unnecessary field */ break;
 				case 1: std::cerr << "SUBTYPE FILETYPE_REDUCEDIMAGE" << std::endl; break;
@@ -478,14 +699,14 @@ bool TiffHeader::readDirectoryEntry(std::fstream& input) {
 			this->setRows((ulongint)this->readEntryUInteger(input, datatype, count, id));
 			break;
 
-		case 258: // bits per sample (3 numbers)
-			// Currently ignoring, assuming 8 bits/samples, so read the
-			// parameter data byte offset and throw it away:
-			if (this->isBigTiff()) {
-				readLittleEndian8ByteUInt(input);
-			} else {
-				readLittleEndian4ByteUInt(input);
+		case 258: // bits per sample (one for each sample)
+			value = readBitsPerSample(input, datatype, count);
+			if ((value != 8) && (value != 16)) {
+				std::cerr << "Can only handle 8 or 16 bits per sample, not "
+				          << value << "." << std::endl;
+				return false;
 			}
+			this->setBitsPerSample(value);
 			break;
 
 		case 259: // compression scheme
@@ -554,10 +775,12 @@ bool TiffHeader::readDirectoryEntry(std::fstream& input) {
 
 		case 284: // planar configuration
 			value = (ulongint)this->readEntryUInteger(input, datatype, count, id);
-			if (value != 1) {
-				std::cerr << "Can only handle contiguous pixel data." << std::endl;
+			// 1 = interleaved samples, 2 = separate plane for each sample
+			if ((value != 1) && (value != 2)) {
+				std::cerr << "Unknown planar configuration: " << value << std::endl;
 				return false;
 			}
+			m_planar = (value == 2);
 			break;
 
 		case 296: // resolution units
@@ -588,16 +811,16 @@ bool TiffHeader::readDirectoryEntry(std::fstream& input) {
 			break;
 
 		default:  // ignore unknown parameters
-			value = readLittleEndian4ByteUInt(input);
+			value = read4ByteUInt(input);
 			if (this->isBigTiff()) {
 				// read next four bytes as well (presume 4 all are zeros)
-				readLittleEndian4ByteUInt(input);
+				read4ByteUInt(input);
 			}
 			std::cerr << "UNKNOWN ID TYPE " << id
 			     << " datatype " << datatype << " count " << count << " value " << value << std::endl;
 	}
 
-	return true;
+	return !m_parseError;
 }
 
 
@@ -610,15 +833,15 @@ bool TiffHeader::readDirectoryEntry(std::fstream& input) {
 void TiffHeader::writeDirectoryOffset(std::ostream& output, ulonglongint offset) {
 	if (m_diroffset_offset == 0) {
 		std::cerr << "Error: directory offset unknown" << std::endl;
-		exit(1);
+		return;
 	}
 	output.seekp(m_diroffset_offset, output.beg);
 	if (this->isBigTiff()) {
 		// offset field is 8 bytes
-		writeLittleEndian8ByteUInt(output, offset);
+		write8ByteUInt(output, offset);
 	} else {
 		// offset field is 4 bytes
-		writeLittleEndian4ByteUInt(output, offset);
+		write4ByteUInt(output, offset);
 	}
 }
 
@@ -633,21 +856,21 @@ void TiffHeader::writeDirectoryOffset(std::ostream& output, ulonglongint offset)
 bool TiffHeader::writeDirectoryEntry(std::fstream& output, int tag, int newvalue) {
 
 	// get the parameter type (tag) and make sure it is the expected one
-	int id = readLittleEndian2ByteUInt(output);
+	int id = read2ByteUInt(output);
 	if (id != tag) {
 		std::cerr << "Error: found tag " << id << " but expecting " << tag << std::endl;
-		exit(1);
+		return false;
 	}
 
 	// get the data type
-	int datatype = readLittleEndian2ByteUInt(output);
+	int datatype = read2ByteUInt(output);
 
 	// get number of values in parameter
 	ulonglongint count;
 	if (this->isBigTiff()) {
-		count = readLittleEndian8ByteUInt(output);
+		count = read8ByteUInt(output);
 	} else {
-		count = readLittleEndian4ByteUInt(output);
+		count = read4ByteUInt(output);
 	}
 
 	if (count > 3) {
@@ -666,7 +889,7 @@ bool TiffHeader::writeDirectoryEntry(std::fstream& output, int tag, int newvalue
 
 		default:
 			std::cerr << "Error: unknown tag " << id << std::endl;
-			exit(1);
+			return false;
 	}
 
 	return true;
@@ -688,7 +911,7 @@ void TiffHeader::writeEntryUInteger(std::fstream& output, int datatype,
 		if (!((tag == 273) || (tag == 279))) {
 			std::cerr << "Problem1 reading value, bad parameter count: " << count << std::endl;
 			std::cerr << "TAG IS " << tag << std::endl;
-			exit(1);
+			return;
 		}
 	}
 
@@ -699,16 +922,16 @@ void TiffHeader::writeEntryUInteger(std::fstream& output, int datatype,
 		// of the image in this area.  Only reading first offset from list.
 
 		if (this->isBigTiff()) {
-			ulonglongint valueoffset = readLittleEndian8ByteUInt(output);
+			ulonglongint valueoffset = read8ByteUInt(output);
 			ulonglongint position = output.tellg();
 			this->goToByteIndex(output, valueoffset);
-			writeLittleEndian8ByteUInt(output, value);
+			write8ByteUInt(output, value);
 			this->goToByteIndex(output, position);
 		} else {
-			ulonglongint valueoffset = readLittleEndian4ByteUInt(output);
+			ulonglongint valueoffset = read4ByteUInt(output);
 			ulonglongint position = output.tellg();
 			this->goToByteIndex(output, valueoffset);
-			writeLittleEndian4ByteUInt(output, value);
+			write4ByteUInt(output, value);
 			this->goToByteIndex(output, position);
 		}
 
@@ -716,49 +939,249 @@ void TiffHeader::writeEntryUInteger(std::fstream& output, int datatype,
 		// Need this case for multiple strips.  Assume each strip is the same size.
 
 		if (this->isBigTiff()) {
-			ulonglongint valueoffset = readLittleEndian8ByteUInt(output);
+			ulonglongint valueoffset = read8ByteUInt(output);
 			ulonglongint position = output.tellg();
 			this->goToByteIndex(output, valueoffset);
-			// output = count * adLittleEndian8ByteUInt(output);
-			writeLittleEndian8ByteUInt(output, value);
+			// output = count * read8ByteUInt(output);
+			write8ByteUInt(output, value);
 			this->goToByteIndex(output, position);
 		} else {
-			ulonglongint valueoffset = readLittleEndian4ByteUInt(output);
+			ulonglongint valueoffset = read4ByteUInt(output);
 			ulonglongint position = output.tellg();
 			this->goToByteIndex(output, valueoffset);
-			// output = count * readLittleEndian4ByteUInt(output);
-			writeLittleEndian4ByteUInt(output, value);
+			// output = count * read4ByteUInt(output);
+			write4ByteUInt(output, value);
 			this->goToByteIndex(output, position);
 		}
 
 	} else if (datatype == 3) {  // unsigned short
-		writeLittleEndian2ByteUInt(output, value);
+		write2ByteUInt(output, value);
 		// add buffer bytes
 		if (this->isBigTiff()) {
-			writeLittleEndian2ByteUInt(output, 0);
-			writeLittleEndian4ByteUInt(output, 0);
+			write2ByteUInt(output, 0);
+			write4ByteUInt(output, 0);
 		} else {
-			writeLittleEndian2ByteUInt(output, 0);
+			write2ByteUInt(output, 0);
 		}
 	} else if (datatype == 4) { // unsigned long
-		writeLittleEndian4ByteUInt(output, value);
+		write4ByteUInt(output, value);
 		// add buffer bytes
 		if (this->isBigTiff()) {
-			writeLittleEndian4ByteUInt(output, 0);
+			write4ByteUInt(output, 0);
 		}
 	} else if (datatype == 16) { // unsigned long long
 		if (this->isBigTiff()) {
-			writeLittleEndian8ByteUInt(output, value);
+			write8ByteUInt(output, value);
 		} else {
 			std::cerr << "32-bit TIFF images should not have this data type." << std::endl;
-			exit(1);
+			return;
 		}
 	} else {
 		std::cerr << "Unknown directory entry data type: " << datatype << std::endl;
 		std::cerr << "For TIFF tag " << tag << std::endl;
-		exit(1);
+		return;
+	}
+
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::readArrayValue -- Read one value from a directory entry's
+//      list of integers, which is stored in the entry if it fits, otherwise
+//      at an offset.  The input is left at the end of the entry.
+//
+
+ulonglongint TiffHeader::readArrayValue(std::istream& input, int datatype,
+		ulonglongint count, ulonglongint index) {
+	ulonglongint entrybytes = this->isBigTiff() ? 8 : 4;
+	ulonglongint position = input.tellg();
+	ulonglongint size;
+	switch (datatype) {
+		case 3:  size = 2; break;
+		case 4:  size = 4; break;
+		case 16: size = 8; break;
+		default:
+			std::cerr << "Unknown directory entry data type: " << datatype << std::endl;
+			m_parseError = true;
+			return 0;
+	}
+
+	ulonglongint valueoffset = position;
+	if (count * size > entrybytes) {
+		if (this->isBigTiff()) {
+			valueoffset = read8ByteUInt(input);
+		} else {
+			valueoffset = read4ByteUInt(input);
+		}
+	}
+	this->goToByteIndex(input, valueoffset + index * size);
+	ulonglongint output;
+	switch (size) {
+		case 2:  output = read2ByteUInt(input); break;
+		case 4:  output = read4ByteUInt(input); break;
+		default: output = read8ByteUInt(input); break;
+	}
+	this->goToByteIndex(input, position + entrybytes);
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::readPlaneOffsets -- Find the start of each plane in a planar
+//      image from the strip offsets, where the strips for each plane are
+//      listed in order (and the strips within a plane are assumed to be
+//      contiguous).
+//
+
+bool TiffHeader::readPlaneOffsets(std::istream& input) {
+	int spp = this->getSamplesPerPixel();
+	ulonglongint planebytes = (ulonglongint)this->getRows() * this->getCols()
+			* (m_bitspersample / 8);
+	m_planeoffsets.resize(spp);
+	if (m_stripoffsets_count < (ulonglongint)spp) {
+		// Single strip: the planes follow each other.
+		for (int i=0; i<spp; i++) {
+			m_planeoffsets[i] = this->getDataOffset() + i * planebytes;
+		}
+		return true;
+	}
+	if (m_stripoffsets_count % spp != 0) {
+		std::cerr << "Strip count " << m_stripoffsets_count
+		          << " is not a multiple of the plane count " << spp << std::endl;
+		return false;
+	}
+	ulonglongint strips = m_stripoffsets_count / spp;
+	for (int i=0; i<spp; i++) {
+		this->goToByteIndex(input, m_stripoffsets_entry);
+		m_planeoffsets[i] = readArrayValue(input, m_stripoffsets_type,
+				m_stripoffsets_count, i * strips);
 	}
+	return !m_parseError;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::readBitsPerSample -- Read the bits-per-sample list, which is
+//      stored in the entry if it fits, otherwise at an offset.  Returns 0
+//      if the samples do not all have the same size.
+//
+
+ulongint TiffHeader::readBitsPerSample(std::istream& input, int datatype,
+		ulonglongint count) {
+	ulonglongint entrybytes = this->isBigTiff() ? 8 : 4;
+	ulonglongint position = input.tellg();
+	if ((datatype != 3) || (count == 0)) {
+		std::cerr << "Bits per sample must be a list of shorts." << std::endl;
+		m_parseError = true;
+		return 0;
+	}
+	if (count * 2 > entrybytes) {
+		ulonglongint valueoffset;
+		if (this->isBigTiff()) {
+			valueoffset = read8ByteUInt(input);
+		} else {
+			valueoffset = read4ByteUInt(input);
+		}
+		this->goToByteIndex(input, valueoffset);
+	}
+	ulongint output = read2ByteUInt(input);
+	for (ulonglongint i=1; i<count; i++) {
+		if (read2ByteUInt(input) != output) {
+			output = 0;
+		}
+	}
+	this->goToByteIndex(input, position + entrybytes);
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::read2ByteUInt -- Read a two-byte integer in the byte order
+//      of the file.
+//
+
+ushortint TiffHeader::read2ByteUInt(std::istream& input) {
+	return m_bigEndian ? readBigEndian2ByteUInt(input) : readLittleEndian2ByteUInt(input);
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::read4ByteUInt -- Read a four-byte integer in the byte order
+//      of the file.
+//
 
+ulongint TiffHeader::read4ByteUInt(std::istream& input) {
+	return m_bigEndian ? readBigEndian4ByteUInt(input) : readLittleEndian4ByteUInt(input);
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::read8ByteUInt -- Read an eight-byte integer in the byte order
+//      of the file.
+//
+
+ulonglongint TiffHeader::read8ByteUInt(std::istream& input) {
+	return m_bigEndian ? readBigEndian8ByteUInt(input) : readLittleEndian8ByteUInt(input);
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::write2ByteUInt -- Write a two-byte integer in the byte order
+//      of the file.
+//
+
+void TiffHeader::write2ByteUInt(std::ostream& output, ushortint value) {
+	if (m_bigEndian) {
+		writeBigEndian2ByteUInt(output, value);
+	} else {
+		writeLittleEndian2ByteUInt(output, value);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::write4ByteUInt -- Write a four-byte integer in the byte order
+//      of the file.
+//
+
+void TiffHeader::write4ByteUInt(std::ostream& output, ulongint value) {
+	if (m_bigEndian) {
+		writeBigEndian4ByteUInt(output, value);
+	} else {
+		writeLittleEndian4ByteUInt(output, value);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::write8ByteUInt -- Write an eight-byte integer in the byte order
+//      of the file.
+//
+
+void TiffHeader::write8ByteUInt(std::ostream& output, ulonglongint value) {
+	if (m_bigEndian) {
+		writeBigEndian8ByteUInt(output, value);
+	} else {
+		writeLittleEndian8ByteUInt(output, value);
+	}
 }
 
 
@@ -770,81 +1193,65 @@ void TiffHeader::writeEntryUInteger(std::fstream& output, int datatype,
 //      the width of the data.
 //
 
-ulonglongint TiffHeader::readEntryUInteger(std::fstream& input, int datatype,
+ulonglongint TiffHeader::readEntryUInteger(std::istream& input, int datatype,
 		ulonglongint count, int tag) {
 	if (count != 1) {
 		if (!((tag == 273) || (tag == 279))) {
 			std::cerr << "Problem2 reading value, bad parameter count: " << count << std::endl;
 			std::cerr << "TAG IS " << tag << std::endl;
-			exit(1);
+			m_parseError = true;
+			return 0;
 		}
 	}
 
 	ulonglongint output = 0;
 
-	if ((tag == 273) && (count > 1)) {
-		// read an offset to the offset, and then read that offset
-		// (assuming all "strips" are contiguous).  This case
-		// is needed for libtiff where it lists an offset for each line
-		// of the image in this area.  Only reading first offset from list.
+	if (tag == 273) {
+		// Keep the location of the strip offsets for finding the planes
+		// of planar images.
+		m_stripoffsets_entry = input.tellg();
+		m_stripoffsets_type  = datatype;
+		m_stripoffsets_count = count;
+	}
 
-		if (this->isBigTiff()) {
-			ulonglongint valueoffset = readLittleEndian8ByteUInt(input);
-			ulonglongint position = input.tellg();
-			this->goToByteIndex(input, valueoffset);
-			output = readLittleEndian8ByteUInt(input);
-			this->goToByteIndex(input, position);
-		} else {
-			ulonglongint valueoffset = readLittleEndian4ByteUInt(input);
-			ulonglongint position = input.tellg();
-			this->goToByteIndex(input, valueoffset);
-			output = readLittleEndian4ByteUInt(input);
-			this->goToByteIndex(input, position);
-		}
+	if ((tag == 273) && (count > 1)) {
+		// Only reading first offset from list (assuming all "strips" are
+		// contiguous).  This case is needed for libtiff where it lists an
+		// offset for each line of the image in this area.
+		output = readArrayValue(input, datatype, count, 0);
 
 	} else if ((tag == 279) && (count > 1)) {
 		// Need this case for multiple strips.  Assume each strip is the same size.
-
-		if (this->isBigTiff()) {
-			ulonglongint valueoffset = readLittleEndian8ByteUInt(input);
-			ulonglongint position = input.tellg();
-			this->goToByteIndex(input, valueoffset);
-			output = count * readLittleEndian8ByteUInt(input);
-			this->goToByteIndex(input, position);
-		} else {
-			ulonglongint valueoffset = readLittleEndian4ByteUInt(input);
-			ulonglongint position = input.tellg();
-			this->goToByteIndex(input, valueoffset);
-			output = count * readLittleEndian4ByteUInt(input);
-			this->goToByteIndex(input, position);
-		}
+		output = count * readArrayValue(input, datatype, count, 0);
 
 	} else if (datatype == 3) {  // unsigned short
-		output = readLittleEndian2ByteUInt(input);
+		output = read2ByteUInt(input);
 		// skip over buffer bytes
 		if (this->isBigTiff()) {
-			readLittleEndian2ByteUInt(input);
-			readLittleEndian4ByteUInt(input);
+			read2ByteUInt(input);
+			read4ByteUInt(input);
 		} else {
-			readLittleEndian2ByteUInt(input);
+			read2ByteUInt(input);
 		}
 	} else if (datatype == 4) { // unsigned long
-		output = readLittleEndian4ByteUInt(input);
+		output = read4ByteUInt(input);
 		// skip over buffer bytes
 		if (this->isBigTiff()) {
-			readLittleEndian4ByteUInt(input);
+			read4ByteUInt(input);
 		}
 	} else if (datatype == 16) { // unsigned long long
 		if (this->isBigTiff()) {
-			output = readLittleEndian8ByteUInt(input);
+			output = read8ByteUInt(input);
 		} else {
 			std::cerr << "32-bit TIFF images should not have this data type." << std::endl;
-			exit(1);
+			m_parseError = true;
+			return 0;
 		}
 	} else {
 		std::cerr << "Unknown directory entry data type: " << datatype << std::endl;
 		std::cerr << "For TIFF tag " << tag << std::endl;
-		exit(1);
+		m_parseError = true;
+		return 0;
 	}
 
 	return output;
@@ -857,30 +1264,32 @@ ulonglongint TiffHeader::readEntryUInteger(std::fstream& input, int datatype,
 // TiffHeader::readType5Value -- read a double expressed as two 4-byte unsigned longs.
 //
 
-double TiffHeader::readType5Value(std::fstream& input, int datatype,
+double TiffHeader::readType5Value(std::istream& input, int datatype,
 		ulonglongint count, int tag) {
 	if (count != 1) {
 		std::cerr << "Problem3 reading value, bad parameter count: " << count << std::endl;
-		exit(1);
+		m_parseError = true;
+		return -1.0;
 	}
 	if (datatype != 5) {
 		std::cerr << "Wrong data type for reading a double value: " << datatype << "." << std::endl;
-		exit(1);
+		m_parseError = true;
+		return -1.0;
 	}
 
 
 	double value = -1.0;
 	if (this->isBigTiff()) {
-		ulongint top = readLittleEndian4ByteUInt(input);
-		ulongint bot = readLittleEndian4ByteUInt(input);
+		ulongint top = read4ByteUInt(input);
+		ulongint bot = read4ByteUInt(input);
 		value = (double)top / (double)bot;
 	} else {
 		ulonglongint offset;
-		offset = readLittleEndian4ByteUInt(input);
+		offset = read4ByteUInt(input);
  		ulonglongint position = input.tellg();
 		goToByteIndex(input, offset);
-		ulongint top = readLittleEndian4ByteUInt(input);
-		ulongint bot = readLittleEndian4ByteUInt(input);
+		ulongint top = read4ByteUInt(input);
+		ulongint bot = read4ByteUInt(input);
 		// go back to after the entry offset value:
 		goToByteIndex(input, position);
 		value = (double)top / (double)bot;
@@ -895,26 +1304,29 @@ double TiffHeader::readType5Value(std::fstream& input, int datatype,
 // TiffHeader::readType1ByteArray --
 //
 
-std::string TiffHeader::readType1ByteArray(std::fstream& input, int datatype, 
+std::string TiffHeader::readType1ByteArray(std::istream& input, int datatype, 
 	ulonglongint count, int tag) {
 
 	if (count <= 0) {
 		std::cerr << "Problem4 reading value, bad parameter count: " << count << std::endl;
-		exit(1);
+		m_parseError = true;
+		return "";
 	}
 	if (datatype != 1) {
 		std::cerr << "Wrong data type for reading a byte array: " << datatype << "." << std::endl;
-		exit(1);
+		m_parseError = true;
+		return "";
 	}
 
 	std::vector<char> value(count, 0);
 
 	if (this->isBigTiff()) {
 		std::cerr << "DON'T KNOW HOW TO READ A BIGTIFF BYTE ARRAY" << std::endl;
-		exit(1);
+		m_parseError = true;
+		return "";
 	} else {
 		ulonglongint offset;
-		offset = readLittleEndian4ByteUInt(input);
+		offset = read4ByteUInt(input);
  		ulonglongint position = input.tellg();
 		goToByteIndex(input, offset);
 		input.read(value.data(), count);
@@ -937,16 +1349,18 @@ std::cerr << "READING COUNT " << count << " STRING " << output << std::endl;
 // TiffHeader::readType2String -- read a string
 //
 
-std::string TiffHeader::readType2String(std::fstream& input, int datatype,
+std::string TiffHeader::readType2String(std::istream& input, int datatype,
 		ulonglongint count, int tag) {
 
 	if (count <= 0) {
 		std::cerr << "Problem4 reading value, bad parameter count: " << count << std::endl;
-		exit(1);
+		m_parseError = true;
+		return "";
 	}
 	if (datatype != 2) {
 		std::cerr << "Wrong data type for reading a string: " << datatype << "." << std::endl;
-		exit(1);
+		m_parseError = true;
+		return "";
 	}
 
 	int size = count + 100;
@@ -957,10 +1371,12 @@ std::string TiffHeader::readType2String(std::fstream& input, int datatype,
 
 	if (this->isBigTiff()) {
 		std::cerr << "DON'T KNOW HOW TO READ A BIGTIFF STRING" << std::endl;
-		exit(1);
+		delete [] buffer;
+		m_parseError = true;
+		return "";
 	} else {
 		ulonglongint offset;
-		offset = readLittleEndian4ByteUInt(input);
+		offset = read4ByteUInt(input);
  		ulonglongint position = input.tellg();
 		goToByteIndex(input, offset);
 		input.read(buffer, count);
@@ -983,18 +1399,40 @@ std::string TiffHeader::readType2String(std::fstream& input, int datatype,
 
 //////////////////////////////
 //
-// TiffHeader::getPixelOffset --
+// TiffHeader::getPixelOffset -- Return the byte offset of a pixel in an
+//     image with interleaved samples (or of its first sample in a planar
+//     image; see getSampleOffset).
 //
 
 ulonglongint TiffHeader::getPixelOffset(ulonglongint pindex) const {
-	return (ulonglongint)getDataOffset() + (ulonglongint)3 * (ulonglongint)pindex;
+	if (isPlanar()) {
+		return getPlaneOffset(0) + (ulonglongint)(getBitsPerSample() / 8) * pindex;
+	}
+	return (ulonglongint)getDataOffset() + (ulonglongint)getBytesPerPixel() * pindex;
 }
 
 
 ulonglongint TiffHeader::getPixelOffset(ulongint rindex, ulongint cindex) const {
-	return (ulonglongint)this->getDataOffset() +
-			(ulonglongint)3 * (ulonglongint)rindex * (ulonglongint)this->getCols() +
-			(ulonglongint)3 * (ulonglongint)cindex;
+	return getPixelOffset((ulonglongint)rindex * (ulonglongint)this->getCols() + cindex);
+}
+
+
+
+//////////////////////////////
+//
+// TiffHeader::getSampleOffset -- Return the byte offset of one channel of
+//     a pixel, for either interleaved or planar images.
+//
+
+ulonglongint TiffHeader::getSampleOffset(ulongint rindex, ulongint cindex,
+		int channel) const {
+	ulonglongint pindex = (ulonglongint)rindex * (ulonglongint)this->getCols() + cindex;
+	ulonglongint samplebytes = getBitsPerSample() / 8;
+	if (isPlanar()) {
+		return getPlaneOffset(channel) + samplebytes * pindex;
+	}
+	return (ulonglongint)getDataOffset() + (ulonglongint)getBytesPerPixel() * pindex +
+			samplebytes * channel;
 }
 
 
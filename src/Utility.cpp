@@ -84,6 +84,70 @@ ushortint readLittleEndian2ByteUInt(std::istream& input) {
 
 
 
+//////////////////////////////
+//
+// readBigEndian8ByteUInt -- Read eight-byte int which is in
+//      big-endian order (largest byte is first).
+//
+
+ulonglongint readBigEndian8ByteUInt(std::istream& input) {
+   ucharint buffer[8];
+   input.read((char*)buffer, 8);
+   if (input.eof()) {
+      std::cerr << "Error: unexpected end of file." << std::endl;
+      return 0;
+   }
+	ulonglongint output = 0;
+	for (int i=0; i<8; i++) {
+		output = (output << 8) | buffer[i];
+	}
+   return output;
+}
+
+
+
+//////////////////////////////
+//
+// readBigEndian4ByteUInt -- Read four-byte int which is in
+//      big-endian order (largest byte is first).
+//
+
+ulongint readBigEndian4ByteUInt(std::istream& input) {
+   ucharint buffer[4];
+   input.read((char*)buffer, 4);
+   if (input.eof()) {
+      std::cerr << "Error: unexpected end of file." << std::endl;
+      return 0;
+   }
+	ulongint output = buffer[0];
+	output = (output << 8) | buffer[1];
+	output = (output << 8) | buffer[2];
+	output = (output << 8) | buffer[3];
+   return output;
+}
+
+
+
+//////////////////////////////
+//
+// readBigEndian2ByteUInt -- Read two-byte int which is in
+//      big-endian order (largest byte is first).
+//
+
+ushortint readBigEndian2ByteUInt(std::istream& input) {
+   ucharint buffer[2];
+   input.read((char*)buffer, 2);
+   if (input.eof()) {
+      std::cerr << "Error: unexpected end of file." << std::endl;
+      return 0;
+   }
+	ushortint output = buffer[0];
+	output = (output << 8) | buffer[1];
+   return output;
+}
+
+
+
 //////////////////////////////
 //
 // read1UByte -- Read a single byte from the current position in the file stream.
@@ -172,6 +236,54 @@ void writeLittleEndian2ByteUInt(std::ostream& output, ushortint value) {
 
 
 
+//////////////////////////////
+//
+// writeBigEndian8ByteUInt --
+//
+
+void writeBigEndian8ByteUInt(std::ostream& output, ulonglongint value) {
+	std::string data;
+	data.resize(8);
+	for (int i=0; i<8; i++) {
+		data[7-i] = ucharint(0xff & (value >> (8 * i)));
+	}
+	writeString(output, data);
+}
+
+
+
+//////////////////////////////
+//
+// writeBigEndian4ByteUInt --
+//
+
+void writeBigEndian4ByteUInt(std::ostream& output, ulongint value) {
+	std::string data;
+	data.resize(4);
+	data[0] = ucharint(0xff & (value >> 24));
+	data[1] = ucharint(0xff & (value >> 16));
+	data[2] = ucharint(0xff & (value >> 8));
+	data[3] = ucharint(0xff & value);
+	writeString(output, data);
+}
+
+
+
+//////////////////////////////
+//
+// writeBigEndian2ByteUInt --
+//
+
+void writeBigEndian2ByteUInt(std::ostream& output, ushortint value) {
+	std::string data;
+	data.resize(2);
+	data[0] = ucharint(0xff & (value >> 8));
+	data[1] = ucharint(0xff & value);
+	writeString(output, data);
+}
+
+
+
 //////////////////////////////
 //
 // write1UByte --
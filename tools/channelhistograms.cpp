@@ -1,63 +1,67 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Nov 26 08:10:23 PST 2017
-// Last Modified: Sun Nov 26 08:10:26 PST 2017
+// Last Modified: Mon Oct 19 20:03:41 PDT 2026
 // Filename:      channelhistograms.cpp
 // Web Address:   
 // Syntax:        C++
 // vim:           ts=3:nowrap:ft=text
 //
 // Description:   Create histograms for intensity values for each color.
+// Options:
+//     -j n       Number of threads to read the image with (default one
+//                for each processor).
 //
 
-#include "TiffFile.h"
+#include "ChannelHistogram.h"
+#include "Options.h"
 
 #include <vector>
 
 using namespace std;
 using namespace rip;
+using namespace smf;
 
 ///////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv) {
-	if (argc != 2) {
-		cerr << "Usage: frameduplicates file.tiff\n";
-	}
+	Options options;
+	options.define("j|threads=i:0", "Number of threads (0 = one per processor)");
+	options.process(argc, argv);
 
-	TiffFile tfile;
-	if (!tfile.open(argv[1])) {
-		cerr << "Input filename " << argv[1] << " cannot be opened" << endl;
+	if (options.getArgCount() != 1) {
+		cerr << "Usage: channelhistograms [-j threads] file.tiff\n";
 		exit(1);
 	}
 
-	vector<vector<ulongint>> histograms(3);
-	for (ulongint i=0; i<histograms.size(); i++) {
-		histograms[i].resize(256);
-		std::fill(histograms[i].begin(), histograms[i].end(), 0);
-	}
-	tfile.goToPixelIndex(0);
-	ulongint count = tfile.getPixelCount();
-	for (ulongint i=0; i<count; i++) {
-		ucharint red   = tfile.read1UByte();
-		ucharint green = tfile.read1UByte();
-		ucharint blue  = tfile.read1UByte();
-		histograms[0].at(red)++;
-		histograms[1].at(green)++;
-		histograms[2].at(blue)++;
+	ChannelHistogram histogram;
+	if (!histogram.readImage(options.getArg(1), options.getInteger("threads"))) {
+		cerr << "Input filename " << options.getArg(1) << " cannot be read" << endl;
+		exit(1);
 	}
 
-	cout << "**value\t**red\t**green\t**blue\n";
-	for (ulongint j=0; j<256; j++) {
+	int channels = histogram.getChannelCount();
+	if (channels == 3) {
+		cout << "**value\t**red\t**green\t**blue\n";
+	} else {
+		cout << "**value";
+		for (int i=0; i<channels; i++) {
+			cout << "\t**gray";
+		}
+		cout << "\n";
+	}
+	for (int j=0; j<256; j++) {
 		cout << j;
-		cout << "\t" << histograms[0].at(j);
-		cout << "\t" << histograms[1].at(j);
-		cout << "\t" << histograms[2].at(j);
+		for (int i=0; i<channels; i++) {
+			cout << "\t" << histogram.getCount(i, j);
+		}
 		cout << "\n";
 	}
-	cout << "*-\t*-\t*-\t*-\n";
+	cout << "*-";
+	for (int i=0; i<channels; i++) {
+		cout << "\t*-";
+	}
+	cout << "\n";
 
 	return 0;
 }
-
-
-
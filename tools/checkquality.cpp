@@ -1,16 +1,24 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Feb  8 22:17:15 PST 2018
-// Last Modified: Thu Feb  8 22:17:18 PST 2018
+// Last Modified: Mon Oct 19 23:02:41 PDT 2026
 // Filename:      checkquality.cpp
 // Web Address:   
 // Syntax:        C++
 // vim:           ts=3:nowrap:ft=text
 //
 // Description:   Report to standard error if there are any problems.
+//                Only the margins, shifts and dust are analyzed (see
+//                RollImage::analyzeQuality), unless --full is given.
+// Options:
+//     -n         Roll image has no leaders.
+//     --full     Run the full analysis before checking the quality.
+//     --type name  Roll type for the full analysis (default 88-note).
+//     --dust-sample n  Count the margin dust in every nth row only.
 //
 
 #include "RollImage.h"
+#include "Options.h"
 
 #include <vector>
 
@@ -22,21 +30,40 @@ using namespace rip;
 ///////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv) {
-	if (argc != 2) {
-		cerr << "Usage: frameduplicates file.tiff\n";
+	Options options;
+	options.define("n|no-leaders=b", "Roll image has no leaders");
+	options.define("full=b", "Run the full analysis before checking the quality");
+	options.define("type=s:88-note", "Roll type for the full analysis");
+	options.define("dust-sample=i:1", "Count margin dust in every nth row only");
+	options.process(argc, argv);
+	if (options.getArgCount() != 1) {
+		cerr << "Usage: checkquality [-n] [--full [--type name]] [--dust-sample n] file.tiff\n";
 		exit(1);
 	}
 
 	RollImage roll;
-	if (!roll.open(argv[1])) {
-		cerr << "Input filename " << argv[1] << " cannot be opened" << endl;
+	if (!roll.open(options.getArg(1))) {
+		cerr << "Input filename " << options.getArg(1) << " cannot be opened" << endl;
 		exit(1);
 	}
+	if (options.getBoolean("no-leaders")) {
+		roll.setMissingLeaders(true);
+	}
+	roll.setDustSampling(options.getInteger("dust-sample"));
 
-	roll.loadGreenChannel(255);
-	roll.analyze();
+	if (options.getBoolean("full")) {
+		roll.analyzeRoll(options.getString("type"), 255);
+	} else {
+		roll.loadGreenChannel(255);
+		roll.analyzeQuality();
+	}
+	if (roll.getStatus() != ROLL_OK) {
+		cerr << roll.getStatusMessage() << endl;
+		exit(1);
+	}
 	roll.printQualityReport();
 
 	return 0;
 }
 
+
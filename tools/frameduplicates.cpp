@@ -1,13 +1,17 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Thu Nov 23 11:47:47 PST 2017
-// Last Modified: Sat Nov 25 20:57:58 PST 2017
+// Last Modified: Mon Oct 19 19:12:05 PDT 2026
 // Filename:      frameduplicates.cpp
 // Web Address:   
 // Syntax:        C++
 // vim:           ts=3:nowrap:ft=text
 //
-// Description:   Identify line duplications in a piano-roll image.
+// Description:   Identify line duplications in a piano-roll image.  The
+//                image is read in large blocks of rows in a single pass,
+//                and the duplicated frames are listed on standard output.
+//                If an output image (a copy of the input image) is given,
+//                the duplicated rows are marked in it.
 //
 // References:
 //      https://web.archive.org/web/20160306201233/http://partners.adobe.com/public/developer/en/tiff/TIFF6.pdf (page 13)
@@ -16,36 +20,30 @@
 //
 
 #include "TiffFile.h"
-#include "Crc32.h"
+#include "FrameDuplicates.h"
 
 #include <vector>
-#include <map>
 #include <iomanip>
 
 using namespace std;
 using namespace rip;
 
-class DuplicateInfo {
-	public:
-		int count = 0;
-		vector<ulongint> rows;
-};
-
 // function declarations:
-void   getRowCheckSums            (vector<ulongint>& checksums, TiffFile& tfile);
-void   identifyDuplicateFrames    (fstream& output, TiffFile& tfile, 
-                                   vector<ulongint>& rowchecksums, ulongint framesize);
+void   getDuplicateFrames         (FrameDuplicates& detector, TiffFile& tfile);
 void   markImageDuplicateFrame    (fstream& output, TiffFile& tfile, int color,
-                                   int firstrow, int otherrow, int framesize,
-                                   int dupnum);
-bool   verifyDuplicate            (TiffFile& tfile, int row1, int row2);
+                                   ulongint firstrow, ulongint otherrow,
+                                   ulongint framesize);
+
+// rows to read at a time:
+#define ROW_BLOCK 256
 
 
 ///////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv) {
-	if (argc != 3) {
-		cerr << "Usage: frameduplicates input.tiff output.tiff\n";
+	if ((argc != 2) && (argc != 3)) {
+		cerr << "Usage: frameduplicates input.tiff [output.tiff]\n";
+		exit(1);
 	}
 
 	TiffFile tfile;
@@ -53,15 +51,13 @@ int main(int argc, char** argv) {
 		cerr << "Input filename " << argv[1] << " cannot be opened" << endl;
 		exit(1);
 	}
-
-	fstream output;
-	output.open(argv[2], ios::binary | ios::in | ios::out);
-	if (!output.is_open()) {
-		cerr << "Output filename " << argv[2] << " cannot be opened" << endl;
+	if (tfile.isPlanar()) {
+		cerr << "ERROR: planar images are not supported." << endl;
 		exit(1);
 	}
 
-	ulonglongint expected = (ulonglongint)tfile.getRows() * (ulonglongint)tfile.getCols() * (ulonglongint)3;
+	ulonglongint expected = (ulonglongint)tfile.getRows() * (ulonglongint)tfile.getCols()
+			* (ulonglongint)tfile.getBytesPerPixel();
 	if (expected != tfile.getDataBytes()) {
 		cerr << "ERROR: image size does not match header information." << endl;
 		cerr << "STRIP BYTE COUNT " << tfile.getDataBytes() << endl;
@@ -70,120 +66,80 @@ int main(int argc, char** argv) {
 		exit(1);
 	}
 
-	vector<ulongint> rowchecksums;
-	getRowCheckSums(rowchecksums, tfile);
-	//for (int i=0; i<(int)rowchecksums.size(); i++) {
-	//	cout << rowchecksums[i] << endl;
-	//}
-
-	identifyDuplicateFrames(output, tfile, rowchecksums, 30);
-
-	output.close();
-
-	return 0;
-}
-
-///////////////////////////////////////////////////////////////////////////
-
+	FrameDuplicates detector(30);
+	getDuplicateFrames(detector, tfile);
+	vector<DuplicateInfo>& duplicates = detector.getDuplicates();
 
-//////////////////////////////
-//
-// identifyDuplicateFrames --
-//
-
-void identifyDuplicateFrames(fstream& output, TiffFile& tfile, 
-		vector<ulongint>& rowchecksums, ulongint framesize) {
-
-	map<ulongint, DuplicateInfo> duplicates;
-	for (ulongint i=0; i<rowchecksums.size(); i++) {
-		duplicates[rowchecksums[i]].count++;
-		duplicates[rowchecksums[i]].rows.push_back(i);
+	for (ulongint i=0; i<duplicates.size(); i++) {
+		cout << "DUPLICATE FRAME: rows " << duplicates[i].original
+		     << " to " << duplicates[i].original + duplicates[i].rows - 1
+		     << " repeated at rows " << duplicates[i].duplicate
+		     << " to " << duplicates[i].duplicate + duplicates[i].rows - 1
+		     << endl;
 	}
 
-	int color = 2;
-	vector<int> marked(rowchecksums.size(), -1);
-
-	for (ulongint i=0; i<rowchecksums.size(); i++) {
-		if (marked[i] >0) {
-			continue;
+	if (argc == 3) {
+		if (tfile.getBytesPerPixel() != 3) {
+			cerr << "ERROR: can only mark 24-bit color images." << endl;
+			exit(1);
 		}
-		ulongint checksum = rowchecksums[i];
-		DuplicateInfo& di = duplicates[checksum];
-		if (di.count < 2) {
-			continue;
+		fstream output;
+		output.open(argv[2], ios::binary | ios::in | ios::out);
+		if (!output.is_open()) {
+			cerr << "Output filename " << argv[2] << " cannot be opened" << endl;
+			exit(1);
 		}
-		if (di.rows.size() < 2) {
-			continue;
-		}
-		if (di.rows.at(0) != i) {
-			continue;
-		}
-
-		if ((i == 0) || (marked[i-1] < 0)) {
-			color = (color + 1) % 3;
-		} else if ((i >= framesize) && (marked[i-1] >= 0)) {
-			if (rowchecksums[i] != rowchecksums[i-framesize]) {
-				if (rowchecksums[i] != rowchecksums[i-1]) {
-					color = (color + 1) % 3;
-				}
-			}
-		}
-
-		for (ulongint j=1; j<di.rows.size(); j++) {
-			int ii = di.rows[j];
-			if (!verifyDuplicate(tfile, i, ii)) {
-				continue;
-			}
-			// cerr << "\tDuplicate rows " << i << " and " << ii << endl;
-			marked[i] = color;
-			marked[ii] = color;
-			markImageDuplicateFrame(output, tfile, color, i, ii, 1, j);
+		for (ulongint i=0; i<duplicates.size(); i++) {
+			markImageDuplicateFrame(output, tfile, i % 3, duplicates[i].original,
+					duplicates[i].duplicate, duplicates[i].rows);
 		}
+		output.close();
 	}
 
-	//for (ulongint i=0; i<marked.size(); i++) {
-	//	cerr << marked[i] << endl;
-	//}
-
+	return 0;
 }
 
+///////////////////////////////////////////////////////////////////////////
 
 
 //////////////////////////////
 //
-// verifyDuplicate --
+// getDuplicateFrames -- Read the image in blocks of rows and pass each row
+//     to the duplicate detector.
 //
 
-bool verifyDuplicate(TiffFile& tfile, int row1, int row2) {
-	int rowbytecount = tfile.getCols() * 3;
-	tfile.goToRowColumnIndex(row1, 0);
-	string rowbytes1 = tfile.readString(rowbytecount);
-
-	tfile.goToRowColumnIndex(row2, 0);
-	string rowbytes2 = tfile.readString(rowbytecount);
-	
-	for (int i=0; i<(int)rowbytes1.size(); i++) {
-		if (rowbytes1[i] != rowbytes2[i]) {
-			return false;
+void getDuplicateFrames(FrameDuplicates& detector, TiffFile& tfile) {
+	ulongint rows = tfile.getRows();
+	ulongint rowbytecount = tfile.getCols() * tfile.getBytesPerPixel();
+	vector<char> block(rowbytecount * ROW_BLOCK);
+
+	detector.reserve(rows);
+	tfile.goToPixelIndex(0);
+	for (ulongint r=0; r<rows; r+=ROW_BLOCK) {
+		ulongint count = std::min((ulongint)ROW_BLOCK, rows - r);
+		tfile.read(block.data(), count * rowbytecount);
+		if (!tfile.good()) {
+			cerr << "ERROR: cannot read image data at row " << r << endl;
+			break;
+		}
+		for (ulongint i=0; i<count; i++) {
+			detector.addRow(block.data() + i * rowbytecount, rowbytecount);
 		}
 	}
-
-	return true;
+	detector.finish();
 }
 
 
 
 //////////////////////////////
 //
-// markImageDuplicateFrame -- Mark the duplicate with a half-row solid color.
+// markImageDuplicateFrame -- Mark the original frame with a quarter-row of
+//     solid color on the left, and the duplicate with one on the right.
 //
 
-void markImageDuplicateFrame(fstream& output, TiffFile& tfile, int color, int firstrow, 
-		int otherrow, int framesize, int dupnum) {
+void markImageDuplicateFrame(fstream& output, TiffFile& tfile, int color,
+		ulongint firstrow, ulongint otherrow, ulongint framesize) {
 
-	if (firstrow % 30 == 0) {
-		cerr << "DUPLICATE FRAME PAIR AT " << firstrow << " and " << otherrow << endl;
-	}
 	vector<char> pixel;
 	pixel.resize(3);
 	switch (color % 3) {
@@ -201,44 +157,18 @@ void markImageDuplicateFrame(fstream& output, TiffFile& tfile, int color, int fi
 		quarterrow[3*i+2] = pixel[2];
 	}
 
-	int side = dupnum % 2;
 	ulonglongint offset;
+	ulonglongint rowbytes = (ulonglongint)tfile.getCols() * 3;
 
-	if (dupnum == 1) {
-		for (int i = 0; i<framesize; i++) {
-			offset = tfile.getDataOffset() + (firstrow + i) * tfile.getCols() * 3;
-			output.seekp(offset, output.beg);
-			output.write(quarterrow.data(), qsize * 3);
-		}
-	}
-
-	for (int i = 0; i<framesize; i++) {
-		offset = tfile.getDataOffset() + (otherrow + i) * tfile.getCols() * 3 + side * 3 * qsize * 3;
+	for (ulongint i=0; i<framesize; i++) {
+		offset = tfile.getDataOffset() + (firstrow + i) * rowbytes;
 		output.seekp(offset, output.beg);
 		output.write(quarterrow.data(), qsize * 3);
 	}
-}
-
 
-
-//////////////////////////////
-//
-// getRowCheckSums -- Calculate checksums for each row of the image.
-//
-
-void getRowCheckSums(vector<ulongint>& checksums, TiffFile& tfile) {
-	tfile.goToPixelIndex(0);
-	int rowbytecount = tfile.getCols() * 3;
-	string rowbytes;
-
-	checksums.resize(tfile.getRows());
-	ulongint crc;
-	for (ulongint i=0; i<tfile.getRows(); i++) {
-		rowbytes = tfile.readString(rowbytecount);
-    	crc = crc32_fast(rowbytes.data(), rowbytecount, 0);
-		checksums[i] = crc;
+	for (ulongint i=0; i<framesize; i++) {
+		offset = tfile.getDataOffset() + (otherrow + i) * rowbytes + 3 * qsize * 3;
+		output.seekp(offset, output.beg);
+		output.write(quarterrow.data(), qsize * 3);
 	}
 }
-
-
-
@@ -0,0 +1,659 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 15:21:07 PDT 2026
+// Last Modified: Mon Oct 19 15:21:11 PDT 2026
+// Filename:      makeroll.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Generate a synthetic piano-roll scan as an uncompressed
+//                TIFF image, along with a ground-truth list of the holes
+//                punched into it.  Used for benchmarking and regression
+//                testing of tiff2holes without access to real scans.
+//                The image is written one row at a time, so very long
+//                rolls can be generated with little memory.
+// Options:
+//     -r           Red Welte-Mignon (T-100) tracker layout.
+//     -g           Green Welte-Mignon (T-98) tracker layout.
+//     -l           Welte-Mignon Licensee tracker layout.
+//     -a           Ampico tracker layout.
+//     -d           Duo-Art tracker layout.
+//     --65         65-note tracker layout (6 holes/inch).
+//     --88         88-note tracker layout (default).
+//     -m           Write a monochrome (8-bit) image instead of 24-bit RGB.
+//     --bigtiff    Always write a BigTIFF (automatic for files over 4GB).
+//     --16         Write 16-bit samples (48-bit RGB or 16-bit monochrome).
+//     --length     Roll length in inches (default 120).
+//     --spacing    Tracker hole spacing in pixels (default from roll type).
+//     --holes      Number of music holes (default 3000).
+//     --drift      Amplitude of slow lateral drift in pixels (default 3).
+//     --period     Period of the lateral drift in inches (default 30).
+//     --shifts     Number of abrupt lateral shifts (default 0).
+//     --tears      Number of edge tears (default 0).
+//     --dust       Dust particles per square inch (default 0.5).
+//     --leader     Leader length in inches, 0 for none (default 20).
+//     --leader-shape  Shape of the leader tip: "taper" or "round".
+//     --seed       Random number seed (default 1).
+//     --truth file Write the ground-truth hole list to file.
+//
+// Notes:         Images are at least 4200 pixels wide since the tracker
+//                bar analysis in tiff2holes requires more than 4096
+//                columns.  Use "tiff2holes -n" when --leader 0 is given.
+//
+
+#include "RollImage.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace rip;
+
+class SynthHole {
+	public:
+		ulongint row;      // first row of the hole
+		ulongint length;   // length of the hole in rows
+		double   center;   // center column of the hole without drift
+		double   width;    // width of the hole in pixels
+		int      track;    // tracker hole index (0 = leftmost)
+};
+
+class SynthShift {
+	public:
+		ulongint row;      // starting row of the shift
+		ulongint length;   // number of rows over which the shift happens
+		double   amount;   // lateral displacement in pixels
+};
+
+class SynthTear {
+	public:
+		ulongint row;      // first row of the tear
+		ulongint length;   // length of the tear in rows
+		double   depth;    // maximum depth of the tear in pixels
+		bool     bass;     // true for bass (left) edge, false for treble edge
+};
+
+class SynthDust {
+	public:
+		ulongint row;      // top row of the dust particle
+		double   col;      // center column of the dust particle
+		double   radius;   // radius of the dust particle in pixels
+};
+
+void   generateHoles      (vector<SynthHole>& holes, int count, int tracks,
+                           double firsthole, double spacing, ulongint startrow,
+                           ulongint endrow, double ppi, mt19937& rng);
+void   generateShifts     (vector<SynthShift>& shifts, int count, ulongint startrow,
+                           ulongint endrow, mt19937& rng);
+void   generateTears      (vector<SynthTear>& tears, int count, double maxdepth,
+                           ulongint startrow, ulongint endrow, mt19937& rng);
+void   generateDust       (vector<SynthDust>& dust, double density, ulongint rows,
+                           ulongint cols, double ppi, mt19937& rng);
+double getDrift           (ulongint row, double amplitude, double period,
+                           vector<SynthShift>& shifts);
+void   writeTiffHeader    (ostream& out, ulongint rows, ulongint cols, int spp,
+                           int bits, bool bigtiff);
+void   writeTruth         (ostream& out, vector<SynthHole>& holes,
+                           vector<SynthShift>& shifts, vector<SynthTear>& tears,
+                           const string& rolltype, ulongint rows, ulongint cols,
+                           double spacing, double firsthole, ulongint leaderrows,
+                           double amplitude, double period);
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("r|red|red-welte|welte-red=b", "Red-Welte (T-100) tracker layout");
+	options.define("g|green|green-welte|welte-green=b", "Green-Welte (T-98) tracker layout");
+	options.define("l|licensee|licensee-welte|welte-licensee=b", "Licensee tracker layout");
+	options.define("a|ampico=b", "Ampico tracker layout");
+	options.define("d|duo-art=b", "Duo-Art tracker layout");
+	options.define("5|65|65-note|65-hole=b", "65-note tracker layout");
+	options.define("8|88|88-note|88-hole=b", "88-note tracker layout");
+	options.define("m|monochrome=b", "Write a monochrome (single-channel) TIFF");
+	options.define("bigtiff=b", "Always write a BigTIFF image");
+	options.define("16|16-bit=b", "Write 16 bits per sample instead of 8");
+	options.define("length=d:120.0", "Roll length in inches");
+	options.define("spacing=d:0.0", "Tracker hole spacing in pixels");
+	options.define("holes=i:3000", "Number of music holes");
+	options.define("drift=d:3.0", "Lateral drift amplitude in pixels");
+	options.define("period=d:30.0", "Lateral drift period in inches");
+	options.define("shifts=i:0", "Number of abrupt lateral shifts");
+	options.define("tears=i:0", "Number of edge tears");
+	options.define("dust=d:0.5", "Dust particles per square inch");
+	options.define("leader=d:20.0", "Leader length in inches (0 for none)");
+	options.define("leader-shape=s:taper", "Shape of leader tip: taper or round");
+	options.define("seed=i:1", "Random number seed");
+	options.define("truth=s", "Write ground-truth hole list to the given filename");
+	options.process(argc, argv);
+
+	if (options.getArgCount() != 1) {
+		cerr << "Usage: makeroll [-rglad58m] [--length in] [--truth holes.txt] output.tiff" << endl;
+		exit(1);
+	}
+
+	RollOptions rolloptions;
+	if (options.getBoolean("red-welte")) {
+		rolloptions.setRollTypeRedWelte();
+	} else if (options.getBoolean("green-welte")) {
+		rolloptions.setRollTypeGreenWelte();
+	} else if (options.getBoolean("licensee-welte")) {
+		rolloptions.setRollTypeLicenseeWelte();
+	} else if (options.getBoolean("ampico")) {
+		rolloptions.setRollTypeAmpico();
+	} else if (options.getBoolean("duo-art")) {
+		rolloptions.setRollTypeDuoArt();
+	} else if (options.getBoolean("65-note")) {
+		rolloptions.setRollType65Note();
+	} else {
+		rolloptions.setRollType88Note();
+	}
+
+	string shape = options.getString("leader-shape");
+	if ((shape != "taper") && (shape != "round")) {
+		cerr << "Leader shape must be \"taper\" or \"round\"" << endl;
+		exit(1);
+	}
+
+	double ppi = rolloptions.getPixelsPerInch();
+	int tracks = rolloptions.getExpectedTrackerHoleCount();
+	double spacing = options.getDouble("spacing");
+	if (spacing <= 0.0) {
+		spacing = rolloptions.getRollType() == "65-note" ? ppi / 6.0 : ppi / 9.0;
+	}
+
+	// Layout of the roll across the image: the tracker holes are centered
+	// on the paper, with 1.5 tracker spacings between the outer holes and
+	// the paper edge, and a hard margin outside of the paper.
+	double amplitude  = options.getDouble("drift");
+	double period     = options.getDouble("period") * ppi;
+	double paperwidth = (tracks - 1 + 3.0) * spacing;
+	ulongint cols = ulongint(paperwidth + 2 * (0.5 * ppi + amplitude) + 0.5);
+	if (cols < 4200) {
+		cols = 4200;
+	}
+	double paperleft  = (cols - paperwidth) / 2.0;
+	double paperright = paperleft + paperwidth;
+	double firsthole  = paperleft + 1.5 * spacing;
+
+	ulongint leaderrows = ulongint(options.getDouble("leader") * ppi);
+	ulongint rows = ulongint(options.getDouble("length") * ppi) + leaderrows;
+	if (rows < 3 * cols + leaderrows) {
+		// The leader analysis compares margins in square regions at each
+		// end of the image, so keep the roll long enough for them.
+		rows = 3 * cols + leaderrows;
+	}
+	ulongint taperrows = leaderrows * 2 / 5;
+
+	int spp = options.getBoolean("monochrome") ? 1 : 3;
+	int bits = options.getBoolean("16-bit") ? 16 : 8;
+	ulonglongint databytes = (ulonglongint)rows * cols * spp * (bits / 8);
+	bool bigtiff = options.getBoolean("bigtiff") ||
+			(databytes + 1024 > (ulonglongint)0xffffffff);
+
+	mt19937 rng(options.getInteger("seed"));
+	vector<SynthHole> holes;
+	vector<SynthShift> shifts;
+	vector<SynthTear> tears;
+	vector<SynthDust> dust;
+	ulongint startrow = leaderrows + ulongint(ppi);
+	ulongint endrow   = rows - cols / 2;
+	generateHoles(holes, options.getInteger("holes"), tracks, firsthole, spacing,
+			startrow, endrow, ppi, rng);
+	generateShifts(shifts, options.getInteger("shifts"), startrow, endrow, rng);
+	generateTears(tears, options.getInteger("tears"), 1.1 * spacing,
+			startrow, endrow, rng);
+	generateDust(dust, options.getDouble("dust"), rows, cols, ppi, rng);
+
+	fstream output;
+	output.open(options.getArg(1).c_str(), ios::binary | ios::out);
+	if (!output.is_open()) {
+		cerr << "Output filename " << options.getArg(1) << " cannot be opened" << endl;
+		exit(1);
+	}
+	writeTiffHeader(output, rows, cols, spp, bits, bigtiff);
+
+	vector<ucharint> row(cols * spp);
+	vector<ucharint> row16(bits == 16 ? cols * spp * 2 : 0);
+	vector<ulongint> activeHoles;
+	vector<ulongint> activeDust;
+	ulongint nexthole = 0;
+	ulongint nextdust = 0;
+	ulongint noise = 12345;
+	double center = (paperleft + paperright) / 2.0;
+
+	for (ulongint r=0; r<rows; r++) {
+		double drift = getDrift(r, amplitude, period, shifts);
+		double left  = paperleft + drift;
+		double right = paperright + drift;
+
+		if (r < taperrows) {
+			double t = (r + 1.0) / taperrows;
+			if (shape == "round") {
+				t = sqrt(1.0 - (1.0 - t) * (1.0 - t));
+			}
+			double halfwidth = std::max(0.5 * ppi, t * paperwidth / 2.0);
+			left  = center + drift - halfwidth;
+			right = center + drift + halfwidth;
+		}
+
+		for (ulongint i=0; i<tears.size(); i++) {
+			if ((r < tears[i].row) || (r >= tears[i].row + tears[i].length)) {
+				continue;
+			}
+			double half = tears[i].length / 2.0;
+			double depth = tears[i].depth * (1.0 - fabs(r - tears[i].row - half) / half);
+			if (tears[i].bass) {
+				left += depth;
+			} else {
+				right -= depth;
+			}
+		}
+
+		// background is bright (backlit) and paper is a darker gray with
+		// a small amount of texture noise.
+		ulongint pleft  = left  < 0.0 ? 0 : ulongint(left + 0.5);
+		ulongint pright = right > cols ? cols : ulongint(right + 0.5);
+		std::fill(row.begin(), row.end(), 255);
+		for (ulongint c=pleft; c<pright; c++) {
+			noise = noise * 1103515245 + 12345;
+			ucharint value = ucharint(162 + ((noise >> 16) & 0x0f));
+			for (int s=0; s<spp; s++) {
+				row[c * spp + s] = value;
+			}
+		}
+
+		while ((nexthole < holes.size()) && (holes[nexthole].row <= r)) {
+			activeHoles.push_back(nexthole++);
+		}
+		for (ulongint i=0; i<activeHoles.size(); i++) {
+			SynthHole& hole = holes[activeHoles[i]];
+			if (r >= hole.row + hole.length) {
+				activeHoles[i] = activeHoles.back();
+				activeHoles.pop_back();
+				i--;
+				continue;
+			}
+			// Round the ends of the hole to match a punched circle.
+			double radius = hole.width / 2.0;
+			double dy = 0.0;
+			if (r - hole.row < radius) {
+				dy = radius - (r - hole.row);
+			} else if (hole.row + hole.length - 1 - r < radius) {
+				dy = radius - (hole.row + hole.length - 1 - r);
+			}
+			double halfwidth = sqrt(std::max(0.0, radius * radius - dy * dy));
+			ulongint c1 = ulongint(hole.center + drift - halfwidth + 0.5);
+			ulongint c2 = ulongint(hole.center + drift + halfwidth + 0.5);
+			std::fill(row.begin() + c1 * spp, row.begin() + c2 * spp, 255);
+		}
+
+		// Dust is a small bright pinhole in the paper or a dark speck on
+		// the background.
+		while ((nextdust < dust.size()) && (dust[nextdust].row <= r)) {
+			activeDust.push_back(nextdust++);
+		}
+		for (ulongint i=0; i<activeDust.size(); i++) {
+			SynthDust& speck = dust[activeDust[i]];
+			double dy = r - speck.row - speck.radius;
+			if (dy > speck.radius) {
+				activeDust[i] = activeDust.back();
+				activeDust.pop_back();
+				i--;
+				continue;
+			}
+			double halfwidth = sqrt(std::max(0.0, speck.radius * speck.radius - dy * dy));
+			ulongint c1 = ulongint(std::max(0.0, speck.col - halfwidth + 0.5));
+			ulongint c2 = ulongint(std::min((double)cols, speck.col + halfwidth + 0.5));
+			for (ulongint c=c1; c<c2; c++) {
+				ucharint value = ((c >= pleft) && (c < pright)) ? 255 : 40;
+				for (int s=0; s<spp; s++) {
+					row[c * spp + s] = value;
+				}
+			}
+		}
+
+		if (bits == 16) {
+			// Expand to 16 bits (value * 257), little-endian:
+			for (ulongint i=0; i<row.size(); i++) {
+				row16[i * 2]     = row[i];
+				row16[i * 2 + 1] = row[i];
+			}
+			output.write((char*)row16.data(), row16.size());
+		} else {
+			output.write((char*)row.data(), row.size());
+		}
+	}
+	output.close();
+
+	if (options.getBoolean("truth")) {
+		ofstream truth(options.getString("truth").c_str());
+		if (!truth.is_open()) {
+			cerr << "Cannot write ground truth to " << options.getString("truth") << endl;
+			exit(1);
+		}
+		writeTruth(truth, holes, shifts, tears, rolloptions.getRollType(), rows, cols,
+				spacing, firsthole, leaderrows, amplitude, period);
+	}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// generateHoles -- Place holes along each tracker hole position, with
+//    the holes divided evenly between the positions.  Each hole is
+//    placed randomly within its own slot along the roll so that holes
+//    in the same position never overlap.  Holes are returned sorted by
+//    starting row.
+//
+
+void generateHoles(vector<SynthHole>& holes, int count, int tracks,
+		double firsthole, double spacing, ulongint startrow, ulongint endrow,
+		double ppi, mt19937& rng) {
+	holes.clear();
+	if ((count <= 0) || (tracks <= 0) || (endrow <= startrow)) {
+		return;
+	}
+	uniform_real_distribution<double> unit(0.0, 1.0);
+	double width = 0.6 * spacing;
+	int pertrack = (count + tracks - 1) / tracks;
+	double slot = double(endrow - startrow) / pertrack;
+	double mingap = 0.05 * ppi;
+	for (int t=0; t<tracks; t++) {
+		for (int i=0; i<pertrack; i++) {
+			if ((int)holes.size() >= count) {
+				break;
+			}
+			// Mostly short attack holes, with some long sustained holes.
+			double length;
+			if (unit(rng) < 0.6) {
+				length = (0.06 + 0.14 * unit(rng)) * ppi;
+			} else {
+				length = (0.2 + 1.8 * unit(rng)) * ppi;
+			}
+			length = std::min(length, slot - mingap);
+			if (length < width) {
+				continue;
+			}
+			SynthHole hole;
+			hole.row    = startrow + ulongint(i * slot + unit(rng) * (slot - mingap - length));
+			hole.length = ulongint(length);
+			hole.center = firsthole + t * spacing;
+			hole.width  = width;
+			hole.track  = t;
+			holes.push_back(hole);
+		}
+	}
+	std::stable_sort(holes.begin(), holes.end(),
+		[](const SynthHole& a, const SynthHole& b) -> bool {
+			return a.row < b.row;
+		});
+}
+
+
+
+//////////////////////////////
+//
+// generateShifts -- Abrupt lateral movements of the paper, as happen when
+//    the scanner operator adjusts the roll.
+//
+
+void generateShifts(vector<SynthShift>& shifts, int count, ulongint startrow,
+		ulongint endrow, mt19937& rng) {
+	shifts.clear();
+	if ((count <= 0) || (endrow <= startrow)) {
+		return;
+	}
+	uniform_real_distribution<double> unit(0.0, 1.0);
+	for (int i=0; i<count; i++) {
+		SynthShift shift;
+		shift.row    = startrow + ulongint(unit(rng) * (endrow - startrow));
+		shift.length = 30 + ulongint(unit(rng) * 60);
+		shift.amount = (4.0 + 8.0 * unit(rng)) * (unit(rng) < 0.5 ? -1.0 : 1.0);
+		shifts.push_back(shift);
+	}
+	std::sort(shifts.begin(), shifts.end(),
+		[](const SynthShift& a, const SynthShift& b) -> bool {
+			return a.row < b.row;
+		});
+}
+
+
+
+//////////////////////////////
+//
+// generateTears -- Triangular notches in the paper edges.  The depth is
+//    limited so that tears do not reach the outermost tracker holes.
+//
+
+void generateTears(vector<SynthTear>& tears, int count, double maxdepth,
+		ulongint startrow, ulongint endrow, mt19937& rng) {
+	tears.clear();
+	if ((count <= 0) || (endrow <= startrow)) {
+		return;
+	}
+	uniform_real_distribution<double> unit(0.0, 1.0);
+	for (int i=0; i<count; i++) {
+		SynthTear tear;
+		tear.row    = startrow + ulongint(unit(rng) * (endrow - startrow));
+		tear.length = 20 + ulongint(unit(rng) * 200);
+		tear.depth  = maxdepth * (0.3 + 0.7 * unit(rng));
+		tear.bass   = unit(rng) < 0.5;
+		tears.push_back(tear);
+	}
+	std::sort(tears.begin(), tears.end(),
+		[](const SynthTear& a, const SynthTear& b) -> bool {
+			return a.row < b.row;
+		});
+}
+
+
+
+//////////////////////////////
+//
+// generateDust -- Small particles scattered over the image, sorted by row.
+//    Particles are small enough to be classified as antidust in the paper.
+//
+
+void generateDust(vector<SynthDust>& dust, double density, ulongint rows,
+		ulongint cols, double ppi, mt19937& rng) {
+	dust.clear();
+	ulongint count = ulongint(density * (rows / ppi) * (cols / ppi));
+	uniform_real_distribution<double> unit(0.0, 1.0);
+	for (ulongint i=0; i<count; i++) {
+		SynthDust speck;
+		speck.row    = ulongint(unit(rng) * (rows - 10));
+		speck.col    = unit(rng) * cols;
+		speck.radius = 1.0 + 3.0 * unit(rng);
+		dust.push_back(speck);
+	}
+	std::sort(dust.begin(), dust.end(),
+		[](const SynthDust& a, const SynthDust& b) -> bool {
+			return a.row < b.row;
+		});
+}
+
+
+
+//////////////////////////////
+//
+// getDrift -- Lateral position of the paper at the given row: a slow
+//    sinusoidal drift plus the sum of the shifts before the row (shifts
+//    are linearly ramped over their length).
+//
+
+double getDrift(ulongint row, double amplitude, double period,
+		vector<SynthShift>& shifts) {
+	double output = 0.0;
+	if (period > 0.0) {
+		output = amplitude * sin(2.0 * M_PI * row / period);
+	}
+	for (ulongint i=0; i<shifts.size(); i++) {
+		if (row < shifts[i].row) {
+			break;
+		}
+		if (row >= shifts[i].row + shifts[i].length) {
+			output += shifts[i].amount;
+		} else {
+			output += shifts[i].amount * (row - shifts[i].row) / shifts[i].length;
+		}
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// writeTiffHeader -- Write an uncompressed single-strip TIFF header
+//    (or BigTIFF header) with the image data starting right after it.
+//
+
+void writeTiffHeader(ostream& out, ulongint rows, ulongint cols, int spp,
+		int bits, bool bigtiff) {
+	ulonglongint databytes = (ulonglongint)rows * cols * spp * (bits / 8);
+	int entries = 9;
+
+	writeString(out, "II");
+	if (bigtiff) {
+		writeLittleEndian2ByteUInt(out, 0x2B);
+		writeLittleEndian2ByteUInt(out, 8);
+		writeLittleEndian2ByteUInt(out, 0);
+		writeLittleEndian8ByteUInt(out, 16);
+		ulonglongint dataoffset = 16 + 8 + entries * 20 + 8;
+
+		int tags[9]        = { 256, 257, 258, 259, 262, 273, 277, 278, 279 };
+		int types[9]       = {   4,   4,   3,   3,   3,  16,   3,   4,  16 };
+		ulonglongint counts[9] = { 1, 1, (ulonglongint)spp, 1, 1, 1, 1, 1, 1 };
+		ulonglongint values[9] = { cols, rows, 0, 1, spp == 3 ? 2ULL : 1ULL,
+				dataoffset, (ulonglongint)spp, rows, databytes };
+
+		writeLittleEndian8ByteUInt(out, entries);
+		for (int i=0; i<entries; i++) {
+			writeLittleEndian2ByteUInt(out, tags[i]);
+			writeLittleEndian2ByteUInt(out, types[i]);
+			writeLittleEndian8ByteUInt(out, counts[i]);
+			if (tags[i] == 258) {
+				// up to four bits-per-sample values fit in the entry
+				for (int j=0; j<4; j++) {
+					writeLittleEndian2ByteUInt(out, j < spp ? bits : 0);
+				}
+			} else if (types[i] == 3) {
+				writeLittleEndian2ByteUInt(out, values[i]);
+				writeLittleEndian2ByteUInt(out, 0);
+				writeLittleEndian4ByteUInt(out, 0);
+			} else if (types[i] == 4) {
+				writeLittleEndian4ByteUInt(out, values[i]);
+				writeLittleEndian4ByteUInt(out, 0);
+			} else {
+				writeLittleEndian8ByteUInt(out, values[i]);
+			}
+		}
+		writeLittleEndian8ByteUInt(out, 0);
+	} else {
+		writeLittleEndian2ByteUInt(out, 0x2A);
+		writeLittleEndian4ByteUInt(out, 8);
+		ulongint bpsoffset = 8 + 2 + entries * 12 + 4;
+		ulongint dataoffset = bpsoffset + 8;
+
+		int tags[9]       = { 256, 257, 258, 259, 262, 273, 277, 278, 279 };
+		int types[9]      = {   4,   4,   3,   3,   3,   4,   3,   4,   4 };
+		ulongint counts[9] = { 1, 1, (ulongint)spp, 1, 1, 1, 1, 1, 1 };
+		ulongint values[9] = { cols, rows, spp == 3 ? bpsoffset : (ulongint)bits, 1,
+				spp == 3 ? 2UL : 1UL, dataoffset, (ulongint)spp, rows,
+				(ulongint)databytes };
+
+		writeLittleEndian2ByteUInt(out, entries);
+		for (int i=0; i<entries; i++) {
+			writeLittleEndian2ByteUInt(out, tags[i]);
+			writeLittleEndian2ByteUInt(out, types[i]);
+			writeLittleEndian4ByteUInt(out, counts[i]);
+			if ((types[i] == 3) && (counts[i] == 1)) {
+				writeLittleEndian2ByteUInt(out, values[i]);
+				writeLittleEndian2ByteUInt(out, 0);
+			} else {
+				writeLittleEndian4ByteUInt(out, values[i]);
+			}
+		}
+		writeLittleEndian4ByteUInt(out, 0);
+		// bits per sample for RGB images (padded to 8 bytes)
+		for (int j=0; j<4; j++) {
+			writeLittleEndian2ByteUInt(out, j < 3 ? bits : 0);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// writeTruth -- Write the generated roll parameters and hole list in
+//    ATON format.  Hole coordinates match those reported by tiff2holes
+//    (origin is the top left corner, widths are bounding box extents).
+//
+
+void writeTruth(ostream& out, vector<SynthHole>& holes, vector<SynthShift>& shifts,
+		vector<SynthTear>& tears, const string& rolltype, ulongint rows,
+		ulongint cols, double spacing, double firsthole, ulongint leaderrows,
+		double amplitude, double period) {
+	out << "@@BEGIN: SYNTHETIC_ROLL\n";
+	out << "@ROLL_TYPE:\t\t"       << rolltype     << "\n";
+	out << "@IMAGE_WIDTH:\t\t"     << cols         << "px\n";
+	out << "@IMAGE_LENGTH:\t\t"    << rows         << "px\n";
+	out << "@LEADER_ROW:\t\t"      << leaderrows   << "px\n";
+	out << "@HOLE_SEPARATION:\t"   << spacing      << "px\n";
+	out << "@FIRST_TRACKER_COL:\t" << firsthole    << "px\n";
+	out << "@DRIFT_AMPLITUDE:\t"   << amplitude    << "px\n";
+	out << "@DRIFT_PERIOD:\t\t"    << period       << "px\n";
+	out << "@MUSICAL_HOLES:\t\t"   << holes.size() << "\n";
+	out << "@SHIFTS:\t\t"          << shifts.size() << "\n";
+	out << "@EDGE_TEARS:\t\t"      << tears.size() << "\n";
+	out << "@@END: SYNTHETIC_ROLL\n\n";
+
+	if (!shifts.empty()) {
+		out << "@@BEGIN: SHIFTS\n";
+		for (ulongint i=0; i<shifts.size(); i++) {
+			out << "@ROW:\t" << shifts[i].row << "\t@LENGTH:\t" << shifts[i].length
+			    << "\t@AMOUNT:\t" << shifts[i].amount << "\n";
+		}
+		out << "@@END: SHIFTS\n\n";
+	}
+
+	if (!tears.empty()) {
+		out << "@@BEGIN: TEARS\n";
+		for (ulongint i=0; i<tears.size(); i++) {
+			out << "@ROW:\t" << tears[i].row << "\t@LENGTH:\t" << tears[i].length
+			    << "\t@DEPTH:\t" << int(tears[i].depth + 0.5)
+			    << "\t@SIDE:\t" << (tears[i].bass ? "bass" : "treble") << "\n";
+		}
+		out << "@@END: TEARS\n\n";
+	}
+
+	out << "@@BEGIN: HOLES\n\n";
+	for (ulongint i=0; i<holes.size(); i++) {
+		SynthHole& hole = holes[i];
+		double drift = getDrift(hole.row, amplitude, period, shifts);
+		out << "@@BEGIN: HOLE\n";
+		out << "@ORIGIN_ROW:\t"   << hole.row << "\n";
+		out << "@ORIGIN_COL:\t"   << ulongint(hole.center + drift - hole.width / 2.0 + 0.5) << "\n";
+		out << "@WIDTH_ROW:\t"    << hole.length << "\n";
+		out << "@WIDTH_COL:\t"    << int(hole.width + 0.5) << "\n";
+		out << "@TRACKER_HOLE:\t" << hole.track << "\n";
+		out << "@@END: HOLE\n\n";
+	}
+	out << "@@END: HOLES\n";
+}
+
+
+
@@ -22,7 +22,9 @@
 //     -d         Assume a Duo-Art piano roll, but option not yet active.
 //     --65       Assume a 65-note Duo-art universal piano roll
 //     --88       Assume a 88-note roll
+//     -x         The image is mirrored left to right (bass on the right side).
 //     -t         Set the paper/hole brightness boundary (from 0-255, with 249 being the default).
+//     --auto-threshold  Choose the paper/hole boundary from the image histogram.
 //
 
 #include "RollImage.h"
@@ -46,7 +48,9 @@ int main(int argc, char** argv) {
 	options.define("5|65|65-note|65-hole=b", "Assume 65-note roll");
 	options.define("8|88|88-note|88-hole=b", "Assume 88-note roll");
 	options.define("t|threshold=i:249", "Brightness threshold for hole/paper separation");
+	options.define("auto-threshold=b", "Choose the hole/paper threshold from the image");
 	options.define("n|no-leaders=b", "Roll image has no tapered leader/preleader sections before holes");
+	options.define("x|mirror=b", "Roll image is mirrored left to right (bass on the right)");
 	options.process(argc, argv);
 
 	if (options.getArgCount() != 2) {
@@ -86,6 +90,14 @@ int main(int argc, char** argv) {
 		roll.setMissingLeaders(true);
 	}
 
+	if (options.getBoolean("mirror")) {
+		roll.setColumnMirror(true);
+	}
+
+	if (!roll.canMergePixelOverlay()) {
+		exit(1);
+	}
+
 	fstream output;
 	output.open(options.getArg(2), ios::binary | ios::in | ios::out);
 	if (!output.is_open()) {
@@ -94,12 +106,17 @@ int main(int argc, char** argv) {
 	}
 
 	int threshold = options.getInteger("threshold");
+	roll.setAutoThreshold(options.getBoolean("auto-threshold"));
 
 	roll.setDebugOn();
 	roll.setWarningOn();
 	roll.loadGreenChannel(threshold);
 
 	roll.analyze();
+	if (roll.getStatus() != ROLL_OK) {
+		cerr << roll.getStatusMessage() << endl;
+		exit(1);
+	}
 	cerr << "DONE ANALYZING" << endl;
 	roll.printRollImageProperties();
 	cerr << "DONE PRINTROLLIMAGEPROPERTIES" << endl;
@@ -116,7 +133,9 @@ int main(int argc, char** argv) {
 	roll.markShifts();
 	cerr << "DONE MARKSHIFTS" << endl;
 	// roll.drawMajorAxes();
-	roll.mergePixelOverlay(output);
+	if (!roll.mergePixelOverlay(output)) {
+		exit(1);
+	}
 	cerr << "DONE MERGEPIXELOVERLAY" << endl;
 	output.close();
 	cerr << "DONE CLOSE" << endl;
@@ -0,0 +1,441 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 17:42:10 PDT 2026
+// Last Modified: Mon Oct 19 17:42:14 PDT 2026
+// Filename:      rollbench.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Time the main processing kernels and the full analysis
+//                of a piano-roll image (typically generated with makeroll).
+//                Results are printed one per line as tab-separated
+//                label, benchmark name, median seconds and minimum seconds,
+//                so that they can be stored as a baseline and compared
+//                against later runs.
+// Options:
+//     -r|-g|-l|-a|-b|-d|--65|--88  Roll type (as in tiff2holes).
+//     -n               Roll image has no leaders.
+//     -t               Brightness threshold (default 249).
+//     --iterations n   Number of times to run each benchmark (default 3).
+//     --label name     Label for results (default is the roll type).
+//     --overlay file   Temporary file for timing mergePixelOverlay
+//                      (default rollbench-overlay.tif, removed afterwards).
+//     --no-overlay     Do not time mergePixelOverlay.
+//     -c|--compare baseline.txt results.txt
+//                      Compare results to a baseline and exit with an
+//                      error if any benchmark is slower than the
+//                      baseline by more than the tolerance.
+//     --tolerance x    Allowed fractional slowdown (default 0.10).
+//     --min-time s     Ignore benchmarks faster than this in the
+//                      baseline (default 0.01 seconds).
+//
+
+#include "RollImage.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace rip;
+
+// BenchRollImage -- give access to the protected processing kernels.
+class BenchRollImage : public RollImage {
+	public:
+		using RollImage::getRawMargins;
+		using RollImage::waterfallDownMargins;
+		using RollImage::waterfallUpMargins;
+		using RollImage::waterfallLeftMargins;
+		using RollImage::waterfallRightMargins;
+		using RollImage::calculateHolePerimeter;
+};
+
+typedef map<string, vector<double> > TimingMap;
+
+bool   setRollType       (RollImage& roll, Options& options);
+bool   openRoll          (BenchRollImage& roll, Options& options, const string& filename);
+string runBenchmarks     (Options& options, const string& filename, TimingMap& timings,
+                          vector<string>& order);
+void   addTiming         (TimingMap& timings, vector<string>& order, const string& name,
+                          double seconds);
+double getSeconds        (chrono::steady_clock::time_point start);
+double getMedian         (vector<double> values);
+void   printResults      (const string& label, TimingMap& timings, vector<string>& order);
+bool   readResults       (const string& filename, map<string, double>& results);
+int    compareResults    (const string& baseline, const string& results,
+                          double tolerance, double mintime);
+bool   copyFile          (const string& source, const string& target);
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("r|red|red-welte|welte-red=b", "Assume Red-Welte (T-100) piano roll");
+	options.define("g|green|green-welte|welte-green=b", "Assume Green-Welte (T-98) piano roll");
+	options.define("l|licensee|licensee-welte|welte-licensee=b", "Assume Licensee piano roll");
+	options.define("a|ampico=b", "Assume Ampico [A] piano roll");
+	options.define("b|ampico-b=b", "Assume Ampico B piano roll");
+	options.define("d|duo-art=b", "Assume Aeolean Duo-Art piano roll");
+	options.define("5|65|65-note|65-hole=b", "Assume 65-note roll");
+	options.define("8|88|88-note|88-hole=b", "Assume 88-note roll");
+	options.define("n|no-leaders=b", "Roll image has no leaders");
+	options.define("t|threshold=i:249", "Brightness threshold for hole/paper separation");
+	options.define("iterations=i:3", "Number of runs for each benchmark");
+	options.define("label=s", "Label for the results");
+	options.define("overlay=s:rollbench-overlay.tif", "Temporary file for overlay timing");
+	options.define("no-overlay=b", "Do not time mergePixelOverlay");
+	options.define("c|compare=b", "Compare results file to baseline file");
+	options.define("tolerance=d:0.10", "Allowed fractional slowdown from baseline");
+	options.define("min-time=d:0.01", "Ignore benchmarks faster than this in baseline");
+	options.process(argc, argv);
+
+	if (options.getBoolean("compare")) {
+		if (options.getArgCount() != 2) {
+			cerr << "Usage: rollbench -c baseline.txt results.txt" << endl;
+			exit(1);
+		}
+		return compareResults(options.getArg(1), options.getArg(2),
+				options.getDouble("tolerance"), options.getDouble("min-time"));
+	}
+
+	if (options.getArgCount() != 1) {
+		cerr << "Usage: rollbench [-rglabd58n] [--iterations n] file.tiff > results.txt" << endl;
+		cerr << "       rollbench -c baseline.txt results.txt" << endl;
+		exit(1);
+	}
+
+	TimingMap timings;
+	vector<string> order;
+	string rolltype = runBenchmarks(options, options.getArg(1), timings, order);
+	string label = options.getString("label");
+	if (label.empty()) {
+		label = rolltype;
+	}
+	printResults(label, timings, order);
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// setRollType -- Set the roll type from the command-line options.
+//
+
+bool setRollType(RollImage& roll, Options& options) {
+	if (options.getBoolean("red-welte")) {
+		roll.setRollTypeRedWelte();
+	} else if (options.getBoolean("green-welte")) {
+		roll.setRollTypeGreenWelte();
+	} else if (options.getBoolean("licensee-welte")) {
+		roll.setRollTypeLicenseeWelte();
+	} else if (options.getBoolean("65-note")) {
+		roll.setRollType65Note();
+	} else if (options.getBoolean("88-note")) {
+		roll.setRollType88Note();
+	} else if (options.getBoolean("ampico")) {
+		roll.setRollTypeAmpico();
+	} else if (options.getBoolean("ampico-b")) {
+		roll.setRollTypeAmpicoB();
+	} else if (options.getBoolean("duo-art")) {
+		roll.setRollTypeDuoArt();
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// openRoll -- Open the image and apply the roll options.
+//
+
+bool openRoll(BenchRollImage& roll, Options& options, const string& filename) {
+	if (!roll.open(filename)) {
+		cerr << "Input filename " << filename << " cannot be opened" << endl;
+		return false;
+	}
+	if (!setRollType(roll, options)) {
+		cerr << "A roll type is required (see tiff2holes)" << endl;
+		return false;
+	}
+	if (options.getBoolean("no-leaders")) {
+		roll.setMissingLeaders(true);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// runBenchmarks -- Time each kernel for the given number of iterations.
+//    The margin kernels run on a freshly loaded image since they modify
+//    the pixel types, and the remaining kernels run after a full analysis.
+//    Returns the roll type.
+//
+
+string runBenchmarks(Options& options, const string& filename, TimingMap& timings,
+		vector<string>& order) {
+	int iterations = options.getInteger("iterations");
+	int threshold  = options.getInteger("threshold");
+	bool overlayQ  = !options.getBoolean("no-overlay");
+	string overlay = options.getString("overlay");
+	string rolltype;
+
+	for (int i=0; i<iterations; i++) {
+		chrono::steady_clock::time_point start;
+		{
+			BenchRollImage roll;
+			if (!openRoll(roll, options, filename)) {
+				exit(1);
+			}
+			rolltype = roll.getRollType();
+
+			start = chrono::steady_clock::now();
+			roll.loadGreenChannel(threshold);
+			addTiming(timings, order, "load", getSeconds(start));
+
+			start = chrono::steady_clock::now();
+			roll.getRawMargins();
+			addTiming(timings, order, "raw-margins", getSeconds(start));
+
+			start = chrono::steady_clock::now();
+			roll.waterfallDownMargins();
+			roll.waterfallUpMargins();
+			roll.waterfallLeftMargins();
+			roll.waterfallRightMargins();
+			addTiming(timings, order, "waterfall", getSeconds(start));
+		}
+
+		BenchRollImage roll;
+		if (!openRoll(roll, options, filename)) {
+			exit(1);
+		}
+		roll.loadGreenChannel(threshold);
+
+		start = chrono::steady_clock::now();
+		roll.analyze();
+		addTiming(timings, order, "analyze", getSeconds(start));
+		if (roll.getStatus() != ROLL_OK) {
+			cerr << roll.getStatusMessage() << endl;
+			exit(1);
+		}
+
+		vector<string> names;
+		vector<double> seconds;
+		roll.getAnalysisStepTimes(names, seconds);
+		map<string, double> steps;
+		for (ulongint j=0; j<names.size(); j++) {
+			steps[names[j]] += seconds[j];
+		}
+		for (ulongint j=0; j<names.size(); j++) {
+			if (steps.find(names[j]) == steps.end()) {
+				continue;  // repeated step already stored
+			}
+			addTiming(timings, order, "step:" + names[j], steps[names[j]]);
+			steps.erase(names[j]);
+		}
+
+		start = chrono::steady_clock::now();
+		for (ulongint j=0; j<roll.holes.size(); j++) {
+			roll.calculateHolePerimeter(*roll.holes[j]);
+		}
+		addTiming(timings, order, "hole-perimeter", getSeconds(start));
+
+		start = chrono::steady_clock::now();
+		roll.analyzeTrackerBarSpacing();
+		addTiming(timings, order, "tracker-spacing", getSeconds(start));
+
+		if (overlayQ && roll.canMergePixelOverlay()) {
+			if (!copyFile(filename, overlay)) {
+				cerr << "Cannot create overlay file " << overlay << endl;
+				exit(1);
+			}
+			fstream output;
+			output.open(overlay.c_str(), ios::binary | ios::in | ios::out);
+			start = chrono::steady_clock::now();
+			if (roll.mergePixelOverlay(output)) {
+				output.flush();
+				addTiming(timings, order, "pixel-overlay", getSeconds(start));
+			}
+			output.close();
+			remove(overlay.c_str());
+		}
+	}
+
+	return rolltype;
+}
+
+
+
+//////////////////////////////
+//
+// addTiming -- Store a timing, remembering the order of first appearance.
+//
+
+void addTiming(TimingMap& timings, vector<string>& order, const string& name,
+		double seconds) {
+	if (timings.find(name) == timings.end()) {
+		order.push_back(name);
+	}
+	timings[name].push_back(seconds);
+}
+
+
+
+//////////////////////////////
+//
+// getSeconds -- Elapsed time since start.
+//
+
+double getSeconds(chrono::steady_clock::time_point start) {
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	return chrono::duration<double>(now - start).count();
+}
+
+
+
+//////////////////////////////
+//
+// getMedian --
+//
+
+double getMedian(vector<double> values) {
+	if (values.empty()) {
+		return 0.0;
+	}
+	std::sort(values.begin(), values.end());
+	ulongint count = values.size();
+	if (count % 2) {
+		return values[count / 2];
+	} else {
+		return (values[count / 2 - 1] + values[count / 2]) / 2.0;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// printResults -- One line per benchmark: label, name, median and
+//    minimum time in seconds.
+//
+
+void printResults(const string& label, TimingMap& timings, vector<string>& order) {
+	for (ulongint i=0; i<order.size(); i++) {
+		vector<double>& values = timings[order[i]];
+		double minimum = *std::min_element(values.begin(), values.end());
+		cout << label << "\t" << order[i] << "\t" << getMedian(values)
+		     << "\t" << minimum << endl;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// readResults -- Read the median times from a results file, indexed
+//    by "label<tab>name".  Lines starting with "#" are ignored.
+//
+
+bool readResults(const string& filename, map<string, double>& results) {
+	ifstream input(filename.c_str());
+	if (!input.is_open()) {
+		cerr << "Cannot read results file " << filename << endl;
+		return false;
+	}
+	string line;
+	while (getline(input, line)) {
+		if (line.empty() || (line[0] == '#')) {
+			continue;
+		}
+		stringstream stream(line);
+		string label;
+		string name;
+		double median;
+		if (!getline(stream, label, '\t') || !getline(stream, name, '\t') ||
+				!(stream >> median)) {
+			continue;
+		}
+		results[label + "\t" + name] = median;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// compareResults -- Print the ratio of each result to the baseline and
+//    return 1 if any benchmark slowed down by more than the tolerance.
+//    Benchmarks faster than mintime in the baseline are reported but
+//    not checked, since their timings are dominated by noise.
+//
+
+int compareResults(const string& baseline, const string& results,
+		double tolerance, double mintime) {
+	map<string, double> base;
+	map<string, double> current;
+	if (!readResults(baseline, base) || !readResults(results, current)) {
+		return 1;
+	}
+
+	int regressions = 0;
+	for (auto it = current.begin(); it != current.end(); it++) {
+		auto found = base.find(it->first);
+		if (found == base.end()) {
+			cout << it->first << "\t" << it->second << "\tNEW" << endl;
+			continue;
+		}
+		double ratio = found->second > 0.0 ? it->second / found->second : 1.0;
+		string status = "OK";
+		if (found->second < mintime) {
+			status = "SKIP";
+		} else if (ratio > 1.0 + tolerance) {
+			status = "REGRESSION";
+			regressions++;
+		}
+		cout << it->first << "\t" << it->second << "\t" << found->second
+		     << "\t" << int(ratio * 1000.0 + 0.5) / 1000.0 << "\t" << status << endl;
+	}
+
+	if (regressions) {
+		cerr << regressions << " benchmark(s) slower than baseline by more than "
+		     << tolerance * 100.0 << "%" << endl;
+		return 1;
+	}
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// copyFile --
+//
+
+bool copyFile(const string& source, const string& target) {
+	ifstream input(source.c_str(), ios::binary);
+	ofstream output(target.c_str(), ios::binary);
+	if (!input.is_open() || !output.is_open()) {
+		return false;
+	}
+	output << input.rdbuf();
+	return true;
+}
+
+
+
@@ -0,0 +1,725 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 18:20:44 PDT 2026
+// Last Modified: Mon Oct 19 18:20:44 PDT 2026
+// Filename:      rolld.cpp
+// Web Address:
+// Syntax:        C++
+// vim:           ts=3:nowrap:ft=text
+//
+// Description:   Roll analysis daemon.  Jobs are received over a Unix
+//                domain socket and analyzed on a shared pool of worker
+//                threads, with an optional cap on the total image memory
+//                used by jobs running at the same time.
+//
+// Options:
+//     -s file    Socket path (default /tmp/rolld.sock).
+//     -j count   Number of worker threads (default: number of CPU cores).
+//     -m MB      Memory cap for running jobs in megabytes (default: no cap).
+//     --send request  Send a request to a running daemon and print the reply.
+//
+// Requests (one line of text per connection, which must arrive within five
+// seconds of connecting):
+//     analyze <roll-type> <file.tiff> [option ...]
+//         Roll types are the names accepted by RollOptions::setRollType()
+//         (such as "welte-red", "88-note" or "duo-art").  Options:
+//            output=file      Write the analysis report to a file rather
+//                             than returning it in the reply.
+//            note-midi=file   Write the note MIDI file.
+//            hole-midi=file   Write the hole MIDI file.
+//            threshold=n      Paper/hole brightness threshold (default 249),
+//                             or "auto" to choose it from the image.
+//            alignment-shift=n  Shift for tracker->MIDI mapping.
+//            no-leaders       Roll image has no leader.
+//            mirror           Roll image is mirrored left to right.
+//            duplicates=mark|drop  List (or remove) duplicated frames.
+//            memory=lean      Free the grayscale image after thresholding
+//                             (halves the memory reserved for the job).
+//            no-embedded-midi Do not include MIDI files in the report.
+//            disregard-rewind-hole
+//            emulate-roll-acceleration
+//         The reply starts with "OK" or "ERROR", followed by the job number
+//         and its timings (queue wait, load and analysis in seconds).  If
+//         no output file is given, the report follows on the next lines.
+//     status
+//         Report the queue depth, running jobs, memory use and job counts.
+//     shutdown
+//         Finish running jobs and then stop the daemon.
+//
+
+#include "RollImage.h"
+#include "Options.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace rip;
+
+// REQUEST_TIMEOUT: seconds allowed for a client to send its request line.
+#define REQUEST_TIMEOUT 5
+
+// MAX_CLIENTS: connections whose requests can be read at the same time.
+#define MAX_CLIENTS 64
+
+
+class RollJob {
+	public:
+		int                 fd = -1;
+		ulongint            number = 0;
+		vector<string>      arguments;
+		chrono::steady_clock::time_point submitted;
+};
+
+
+class RollDaemon {
+	public:
+		                    RollDaemon      (const string& socketpath,
+		                                     int workers, ulonglongint memorycap);
+		bool                run             (void);
+
+	protected:
+		void                worker          (void);
+		void                readClient      (int fd);
+		void                handleClient    (int fd);
+		void                processJob      (RollJob& job);
+		void                reserveMemory   (ulonglongint bytes);
+		void                releaseMemory   (ulonglongint bytes);
+		string              getStatus       (void);
+
+	private:
+		string              m_socketPath;
+		int                 m_workers;
+		ulonglongint        m_memoryCap;
+		int                 m_listener = -1;
+		mutex               m_mutex;
+		condition_variable  m_jobReady;
+		condition_variable  m_memoryReady;
+		deque<RollJob>      m_queue;
+		bool                m_shutdown = false;
+		ulongint            m_clients = 0;
+		condition_variable  m_clientDone;
+		ulongint            m_jobCount = 0;
+		ulongint            m_running = 0;
+		ulongint            m_completed = 0;
+		ulongint            m_failed = 0;
+		ulonglongint        m_memoryUsed = 0;
+		double              m_analysisTime = 0.0;
+};
+
+
+bool   sendRequest    (const string& socketpath, const string& request);
+int    connectSocket  (const string& socketpath);
+bool   readLine       (int fd, string& line, int seconds);
+bool   writeString    (int fd, const string& text);
+double getSeconds     (chrono::steady_clock::time_point start);
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("s|socket=s:/tmp/rolld.sock", "Unix domain socket path");
+	options.define("j|jobs=i:0", "Number of worker threads (0 = number of CPU cores)");
+	options.define("m|memory=i:0", "Memory cap for running jobs in MB (0 = no cap)");
+	options.define("send=s", "Send a request to a running daemon");
+	options.process(argc, argv);
+
+	string socketpath = options.getString("socket");
+	if (options.getBoolean("send")) {
+		return sendRequest(socketpath, options.getString("send")) ? 0 : 1;
+	}
+
+	int workers = options.getInteger("jobs");
+	if (workers <= 0) {
+		workers = thread::hardware_concurrency();
+	}
+	if (workers <= 0) {
+		workers = 1;
+	}
+	ulonglongint memorycap = (ulonglongint)options.getInteger("memory") * 1024 * 1024;
+
+	RollDaemon daemon(socketpath, workers, memorycap);
+	return daemon.run() ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+
+//////////////////////////////
+//
+// RollDaemon::RollDaemon --
+//
+
+RollDaemon::RollDaemon(const string& socketpath, int workers,
+		ulonglongint memorycap) {
+	m_socketPath = socketpath;
+	m_workers = workers;
+	m_memoryCap = memorycap;
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::run -- Listen on the socket and accept requests until a
+//     shutdown request is received.
+//
+
+bool RollDaemon::run(void) {
+	signal(SIGPIPE, SIG_IGN);
+
+	struct sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.size() >= sizeof(address.sun_path)) {
+		cerr << "Socket path " << m_socketPath << " is too long" << endl;
+		return false;
+	}
+	strcpy(address.sun_path, m_socketPath.c_str());
+
+	// Only replace a socket file that no daemon is listening on:
+	struct stat info;
+	if (lstat(m_socketPath.c_str(), &info) == 0) {
+		if (!S_ISSOCK(info.st_mode)) {
+			cerr << m_socketPath << " exists and is not a socket" << endl;
+			return false;
+		}
+		int fd = connectSocket(m_socketPath);
+		if (fd >= 0) {
+			close(fd);
+			cerr << "Another daemon is already listening on " << m_socketPath << endl;
+			return false;
+		}
+		unlink(m_socketPath.c_str());
+	}
+
+	m_listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listener < 0) {
+		cerr << "Cannot create socket" << endl;
+		return false;
+	}
+	if (bind(m_listener, (struct sockaddr*)&address, sizeof(address)) != 0) {
+		cerr << "Cannot bind socket " << m_socketPath << endl;
+		close(m_listener);
+		return false;
+	}
+	if (listen(m_listener, 64) != 0) {
+		cerr << "Cannot listen on socket " << m_socketPath << endl;
+		close(m_listener);
+		return false;
+	}
+	cerr << "rolld: listening on " << m_socketPath << " with " << m_workers
+	     << " workers" << endl;
+
+	vector<thread> pool;
+	for (int i=0; i<m_workers; i++) {
+		pool.emplace_back(&RollDaemon::worker, this);
+	}
+
+	// Requests are read by a thread for each connection, so that a slow
+	// client does not hold up the others.  The listener is polled so that
+	// a shutdown request is noticed without another connection.
+	struct pollfd listener = {m_listener, POLLIN, 0};
+	while (true) {
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_shutdown) {
+				break;
+			}
+		}
+		if (poll(&listener, 1, 250) <= 0) {
+			continue;
+		}
+		int fd = accept(m_listener, NULL, NULL);
+		if (fd < 0) {
+			continue;
+		}
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_clients >= MAX_CLIENTS) {
+				writeString(fd, "ERROR too many connections\n");
+				close(fd);
+				continue;
+			}
+			m_clients++;
+		}
+		thread(&RollDaemon::readClient, this, fd).detach();
+	}
+
+	close(m_listener);
+	unlink(m_socketPath.c_str());
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_clientDone.wait(lock, [this]{ return m_clients == 0; });
+	}
+	m_jobReady.notify_all();
+	for (auto& it : pool) {
+		it.join();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::readClient -- Handle a new connection on its own thread, and
+//     let run() know when it is done.
+//
+
+void RollDaemon::readClient(int fd) {
+	handleClient(fd);
+	lock_guard<mutex> lock(m_mutex);
+	m_clients--;
+	m_clientDone.notify_all();
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::handleClient -- Read a request from a new connection.  Status
+//     and shutdown requests are answered immediately, while analysis
+//     requests are added to the job queue.  The whole request line must
+//     arrive within REQUEST_TIMEOUT seconds.
+//
+
+void RollDaemon::handleClient(int fd) {
+	string line;
+	if (!readLine(fd, line, REQUEST_TIMEOUT)) {
+		writeString(fd, "ERROR no request received\n");
+		close(fd);
+		return;
+	}
+	stringstream tokens(line);
+	vector<string> arguments;
+	string token;
+	while (tokens >> token) {
+		arguments.push_back(token);
+	}
+
+	if (arguments.empty()) {
+		writeString(fd, "ERROR empty request\n");
+		close(fd);
+	} else if (arguments[0] == "status") {
+		writeString(fd, getStatus());
+		close(fd);
+	} else if (arguments[0] == "shutdown") {
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_shutdown = true;
+		}
+		writeString(fd, "OK shutting down\n");
+		close(fd);
+	} else if (arguments[0] == "analyze") {
+		if (arguments.size() < 3) {
+			writeString(fd, "ERROR usage: analyze <roll-type> <file.tiff> [option ...]\n");
+			close(fd);
+			return;
+		}
+		RollJob job;
+		job.fd = fd;
+		job.arguments = arguments;
+		job.submitted = chrono::steady_clock::now();
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_shutdown) {
+				writeString(fd, "ERROR shutting down\n");
+				close(fd);
+				return;
+			}
+			job.number = ++m_jobCount;
+			m_queue.push_back(job);
+		}
+		m_jobReady.notify_one();
+	} else {
+		writeString(fd, "ERROR unknown request: " + arguments[0] + "\n");
+		close(fd);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::worker -- Run jobs from the queue.  Queued jobs are finished
+//     before the worker stops after a shutdown request.
+//
+
+void RollDaemon::worker(void) {
+	while (true) {
+		RollJob job;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_jobReady.wait(lock, [this]{ return m_shutdown || !m_queue.empty(); });
+			if (m_queue.empty()) {
+				return;
+			}
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+		processJob(job);
+		close(job.fd);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::processJob -- Analyze a roll image and send the reply.
+//
+
+void RollDaemon::processJob(RollJob& job) {
+	string rolltype = job.arguments[1];
+	string filename = job.arguments[2];
+	string outputname;
+	string notemidi;
+	string holemidi;
+	int threshold = 249;
+	int planes = 2;
+
+	RollImage roll;
+	for (ulongint i=3; i<job.arguments.size(); i++) {
+		string option = job.arguments[i];
+		string value;
+		auto loc = option.find('=');
+		if (loc != string::npos) {
+			value = option.substr(loc + 1);
+			option = option.substr(0, loc);
+		}
+		if (option == "output") {
+			outputname = value;
+		} else if (option == "note-midi") {
+			notemidi = value;
+		} else if (option == "hole-midi") {
+			holemidi = value;
+		} else if ((option == "threshold") && (value == "auto")) {
+			roll.setAutoThreshold(true);
+		} else if (option == "threshold") {
+			threshold = atoi(value.c_str());
+		} else if (option == "alignment-shift") {
+			roll.setAlignmentShift(atoi(value.c_str()));
+		} else if (option == "no-leaders") {
+			roll.setMissingLeaders(true);
+		} else if (option == "mirror") {
+			roll.setColumnMirror(true);
+		} else if ((option == "duplicates") && (value == "mark")) {
+			roll.setDuplicateFrames(DUPLICATES_MARK);
+		} else if ((option == "duplicates") && (value == "drop")) {
+			roll.setDuplicateFrames(DUPLICATES_DROP);
+		} else if ((option == "memory") && (value == "lean")) {
+			roll.setLeanMemory(true);
+			planes = 1;
+		} else if (option == "no-embedded-midi") {
+			roll.setEmbeddedMidiFiles(false);
+		} else if (option == "disregard-rewind-hole") {
+			roll.setRewindCorrection(false);
+		} else if (option == "emulate-roll-acceleration") {
+			roll.toggleAccelerationEmulation(true);
+		} else {
+			writeString(job.fd, "ERROR job " + to_string(job.number)
+					+ " unknown option: " + option + "\n");
+			lock_guard<mutex> lock(m_mutex);
+			m_failed++;
+			return;
+		}
+	}
+
+	double waittime = getSeconds(job.submitted);
+	auto start = chrono::steady_clock::now();
+	bool status = roll.openMapped(filename);
+
+	// Reserve memory for the image planes (monochrome and pixel type, or
+	// only pixel type in lean mode) and the smaller per-row and per-column
+	// analysis arrays:
+	ulonglongint memory = 0;
+	if (status) {
+		memory = (ulonglongint)roll.getRows() * roll.getCols() * planes
+				+ (ulonglongint)(roll.getRows() + roll.getCols()) * 64;
+		reserveMemory(memory);
+		waittime += getSeconds(start);
+		start = chrono::steady_clock::now();
+	}
+
+	RollStatus result = ROLL_ERROR_OPEN;
+	string message = "Input filename " + filename + " cannot be opened";
+	if (status) {
+		result = roll.analyzeRoll(rolltype, threshold);
+		message = roll.getStatusMessage();
+	}
+	double analysistime = getSeconds(start);
+
+	stringstream report;
+	if (result == ROLL_OK) {
+		if (outputname.empty()) {
+			roll.printRollImageProperties(report);
+		} else {
+			fstream output(outputname.c_str(), ios::out);
+			if (output.is_open()) {
+				roll.printRollImageProperties(output);
+			} else {
+				result = ROLL_ERROR_OPEN;
+				message = "Output filename " + outputname + " cannot be opened";
+			}
+		}
+	}
+	vector<pair<string, bool>> midifiles = {{notemidi, false}, {holemidi, true}};
+	for (auto& it : midifiles) {
+		if ((result != ROLL_OK) || it.first.empty()) {
+			continue;
+		}
+		fstream output(it.first.c_str(), ios::binary | ios::out);
+		if (!output.is_open()) {
+			result = ROLL_ERROR_OPEN;
+			message = "Output filename " + it.first + " cannot be opened";
+			break;
+		}
+		if (it.second) {
+			roll.writeHoleMidiFile(output);
+		} else {
+			roll.writeNoteMidiFile(output);
+		}
+	}
+	double totaltime = getSeconds(start);
+	roll.close();
+	releaseMemory(memory);
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (result == ROLL_OK) {
+			m_completed++;
+		} else {
+			m_failed++;
+		}
+		m_analysisTime += totaltime;
+	}
+
+	stringstream reply;
+	reply << (result == ROLL_OK ? "OK" : "ERROR");
+	reply << " job " << job.number;
+	reply << " wait " << waittime;
+	reply << " analyze " << analysistime;
+	reply << " total " << waittime + totaltime;
+	if (result != ROLL_OK) {
+		// Keep the reply header on a single line:
+		for (auto& ch : message) {
+			if (ch == '\n') {
+				ch = ' ';
+			}
+		}
+		reply << " message " << message;
+	}
+	reply << "\n";
+	reply << report.str();
+	writeString(job.fd, reply.str());
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::reserveMemory -- Wait until there is enough memory under the
+//     cap for a job.  A job is always allowed to run when no other job is
+//     using memory, even if it is larger than the cap.
+//
+
+void RollDaemon::reserveMemory(ulonglongint bytes) {
+	unique_lock<mutex> lock(m_mutex);
+	if (m_memoryCap > 0) {
+		m_memoryReady.wait(lock, [this, bytes]{
+			return (m_memoryUsed == 0) || (m_memoryUsed + bytes <= m_memoryCap);
+		});
+	}
+	m_memoryUsed += bytes;
+	m_running++;
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::releaseMemory -- Return a job's memory reservation.
+//
+
+void RollDaemon::releaseMemory(ulonglongint bytes) {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (bytes > 0) {
+			m_memoryUsed -= bytes;
+			m_running--;
+		}
+	}
+	m_memoryReady.notify_all();
+}
+
+
+
+//////////////////////////////
+//
+// RollDaemon::getStatus -- Return the queue and job statistics.
+//
+
+string RollDaemon::getStatus(void) {
+	lock_guard<mutex> lock(m_mutex);
+	stringstream output;
+	output << "OK";
+	output << " queued "    << m_queue.size();
+	output << " running "   << m_running;
+	output << " completed " << m_completed;
+	output << " failed "    << m_failed;
+	output << " workers "   << m_workers;
+	output << " memory "    << m_memoryUsed / 1024 / 1024;
+	output << " memory-cap " << m_memoryCap / 1024 / 1024;
+	double average = m_completed + m_failed > 0 ?
+			m_analysisTime / (m_completed + m_failed) : 0.0;
+	output << " average-time " << average;
+	output << "\n";
+	return output.str();
+}
+
+
+
+//////////////////////////////
+//
+// sendRequest -- Send a request to the daemon and print its reply.
+//
+
+bool sendRequest(const string& socketpath, const string& request) {
+	int fd = connectSocket(socketpath);
+	if (fd < 0) {
+		cerr << "Cannot connect to " << socketpath << endl;
+		return false;
+	}
+	writeString(fd, request + "\n");
+
+	bool status = true;
+	bool first = true;
+	char buffer[65536];
+	ssize_t count;
+	while ((count = read(fd, buffer, sizeof(buffer))) > 0) {
+		if (first) {
+			status = strncmp(buffer, "OK", 2) == 0;
+			first = false;
+		}
+		cout.write(buffer, count);
+	}
+	close(fd);
+	return status && !first;
+}
+
+
+
+//////////////////////////////
+//
+// connectSocket -- Connect to a Unix domain socket, returning the file
+//     descriptor, or -1 if nothing is listening on it.
+//
+
+int connectSocket(const string& socketpath) {
+	struct sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (socketpath.size() >= sizeof(address.sun_path)) {
+		return -1;
+	}
+	strcpy(address.sun_path, socketpath.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+	if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+
+
+//////////////////////////////
+//
+// readLine -- Read a newline-terminated line from a socket.  The whole
+//     line must arrive within the given number of seconds.
+//
+
+bool readLine(int fd, string& line, int seconds) {
+	line.clear();
+	auto deadline = chrono::steady_clock::now() + chrono::seconds(seconds);
+	char buffer[4096];
+	while (true) {
+		auto remaining = chrono::duration_cast<chrono::milliseconds>(
+				deadline - chrono::steady_clock::now()).count();
+		if (remaining <= 0) {
+			return false;
+		}
+		struct pollfd input = {fd, POLLIN, 0};
+		int ready = poll(&input, 1, (int)remaining);
+		if ((ready < 0) && (errno == EINTR)) {
+			continue;
+		}
+		if (ready <= 0) {
+			return false;
+		}
+		// Only one request is sent on a connection, so any bytes after the
+		// newline can be ignored.
+		ssize_t count = read(fd, buffer, sizeof(buffer));
+		if (count <= 0) {
+			return !line.empty();
+		}
+		for (ssize_t i=0; i<count; i++) {
+			if (buffer[i] == '\n') {
+				return true;
+			}
+			line += buffer[i];
+		}
+		if (line.size() > 65536) {
+			return false;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// writeString -- Write all of a string to a socket.
+//
+
+bool writeString(int fd, const string& text) {
+	ulongint offset = 0;
+	while (offset < text.size()) {
+		ssize_t count = write(fd, text.data() + offset, text.size() - offset);
+		if (count <= 0) {
+			return false;
+		}
+		offset += count;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// getSeconds -- Return the elapsed time in seconds since the start time.
+//
+
+double getSeconds(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+
@@ -8,10 +8,21 @@
 // vim:           ts=3:nowrap:ft=text
 //
 // Description:   Correct for left-right drifting along the length of a roll image.
+//                With two filenames, the input image is analyzed and the
+//                straightened image is written directly from the analysis.
+//                With three, the drift is read from the DRIFT section of an
+//                analysis report made earlier by tiff2holes.
 //
 // Options:
+//     -b n       Brightness of pixels uncovered by the shift (default 254).
+//     -s         Shift rows by fractions of a pixel (direct mode only).
+//     -n         Roll image has no leaders (direct mode only).
+//     -x         Roll image is mirrored left to right (direct mode only).
+//     -t n       Paper/hole brightness threshold (direct mode only).
+//     --type name  Roll type to analyze (direct mode only, default 88-note).
 //
 
+#include "RollImage.h"
 #include "TiffFile.h"
 #include "Options.h"
 
@@ -24,6 +35,7 @@ using namespace smf;
 bool getDriftAnalysis(vector<pair<int, double>>& driftAnalysis, const string& filename);
 void fillDriftArray(vector<double>& drift, vector<pair<int, double>>& driftAnalysis, int rows);
 void shiftImageRow(fstream& output, TiffFile& tfile, int row, int adjust);
+void straightenDirectly(Options& options);
 
 int Brightness = 254;
 
@@ -32,12 +44,23 @@ int Brightness = 254;
 int main(int argc, char** argv) {
 	Options options;
 	options.define("b|brightness=i:254", "Brightness level for margin edge");
+	options.define("s|subpixel=b", "Interpolate rows between pixels");
+	options.define("n|no-leaders=b", "Roll image has no leaders");
+	options.define("x|mirror=b", "Roll image is mirrored left to right");
+	options.define("t|threshold=i:249", "Brightness threshold for hole/paper separation");
+	options.define("type=s:88-note", "Roll type to analyze");
 	options.process(argc, argv);
 
 	Brightness = options.getInteger("brightness");
 
+	if (options.getArgCount() == 2) {
+		straightenDirectly(options);
+		return 0;
+	}
+
 	if (options.getArgCount() != 3) {
-		cerr << "Usage: straighten analysis.txt original.tiff output.tiff" << endl;
+		cerr << "Usage: straighten [-s] [--type name] original.tiff output.tiff" << endl;
+		cerr << "   or: straighten analysis.txt original.tiff output.tiff" << endl;
 		cerr << "original.tiff must be a 24-bit color image, uncompressed" << endl;
 		cerr << "output.tiff must be a copy of original.tiff and it will be straightened." << endl;
 		exit(1);
@@ -96,6 +119,42 @@ int main(int argc, char** argv) {
 
 
 
+//////////////////////////////
+//
+// straightenDirectly -- Analyze the input image and write the straightened
+//     image from the drift correction of the analysis (without an
+//     intermediate analysis report).
+//
+
+void straightenDirectly(Options& options) {
+	if (options.getArg(1) == options.getArg(2)) {
+		cerr << "Error: Input and output files cannot be the same" << endl;
+		exit(1);
+	}
+
+	RollImage roll;
+	if (!roll.open(options.getArg(1))) {
+		cerr << "Input filename " << options.getArg(1) << " cannot be opened" << endl;
+		exit(1);
+	}
+	if (options.getBoolean("no-leaders")) {
+		roll.setMissingLeaders(true);
+	}
+	if (options.getBoolean("mirror")) {
+		roll.setColumnMirror(true);
+	}
+	if (roll.analyzeRoll(options.getString("type"), options.getInteger("threshold")) != ROLL_OK) {
+		cerr << roll.getStatusMessage() << endl;
+		exit(1);
+	}
+	if (!roll.writeStraightenedImage(options.getArg(2), options.getBoolean("subpixel"),
+			Brightness)) {
+		exit(1);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // shiftImageRow -- 
@@ -19,7 +19,37 @@
 //     -d         Assume a Duo-Art piano roll, but option not yet active.
 //     --65       Assume a 65-note Duo-art universal piano roll
 //     --88       Assume a 88-note roll
+//     -x         The image is mirrored left to right (bass on the right side).
 //     -t         Set the paper/hole brightness boundary (from 0-255, with 249 being the default).
+//     --auto-threshold  Choose the paper/hole boundary from the image histogram.
+//     --threshold16  Set the paper/hole boundary for 16-bit images at full precision (0-65535).
+//     --note-midi file.mid  Write the note MIDI file (binary) to file.mid.
+//     --hole-midi file.mid  Write the hole MIDI file (binary) to file.mid.
+//     --no-embedded-midi    Do not include MIDI files in the analysis report.
+//     --mmap     Memory map the input file instead of reading it.
+//     --stdin    Read the image from standard input (no filename argument).
+//     --duplicates mark|drop  List duplicated frames (scanner stalls) in the
+//                analysis, and with "drop" remove them before analysis.
+//     --sweep min:max  List the holes found at each threshold in the range.
+//                Every paper pixel at or above min is stored while
+//                sweeping (26 bytes each), so a low min on a long roll is
+//                refused if it would need more than 4 GB of memory.
+//     --rows start:end  Only analyze the given rows of the image (end is
+//                included) for a quick look at part of a roll.  A range
+//                that does not start at row 0 implies -n.
+//     --feet n   Only analyze the first n feet of the roll image.
+//     --leader-only  Only analyze the start of the image with the leader.
+//     --dust-sample n  Count the margin dust in every nth row only, and
+//                report the confidence interval of the dust score.
+//     --lean     Do not keep the grayscale image in memory after thresholding
+//                it (cannot be combined with --sweep).
+//     --straighten file.tiff  Write a copy of the input image with the drift
+//                of the paper removed so that the hole columns are vertical.
+//     --subpixel Shift the rows of the straightened image by fractions of a
+//                pixel rather than whole pixels.
+//     --segments Analyze all pages of the input file(s) as one image.  This is
+//                the default when more than one file is given, for rolls that
+//                were scanned in several overlapping parts.
 //
 
 #include "RollImage.h"
@@ -30,6 +60,8 @@
 using namespace std;
 using namespace rip;
 
+void writeMidiFile(RollImage& roll, const string& filename, bool holeQ);
+
 ///////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char** argv) {
@@ -43,15 +75,37 @@ int main(int argc, char** argv) {
 	options.define("5|65|65-note|65-hole=b", "Assume 65-note roll");
 	options.define("8|88|88-note|88-hole=b", "Assume 88-note roll");
 	options.define("t|threshold=i:249", "Brightness threshold for hole/paper separation");
+	options.define("auto-threshold=b", "Choose the hole/paper threshold from the image");
+	options.define("threshold16=i:-1", "Threshold at 16-bit precision (0-65535) for 16-bit images");
 	options.define("m|monochrome=b", "Input image is a monochrome (single-channel) TIFF");
 	options.define("s|disregard-rewind-hole=b", "Skip rewind hole correction for tracker->MIDI mapping");
 	options.define("n|no-leaders=b", "Roll image has no tapered leader/preleader sections before holes");
+	options.define("x|mirror=b", "Roll image is mirrored left to right (bass on the right)");
 	options.define("e|emulate-roll-acceleration=b", "Add tempo events to note MIDI for acceleration");
 	options.define("i|alignment-shift=i:0", "Shift leftmost valid position for tracker->MIDI mapping");
+	options.define("note-midi=s", "Write note MIDI file (binary) to the given filename");
+	options.define("hole-midi=s", "Write hole MIDI file (binary) to the given filename");
+	options.define("no-embedded-midi=b", "Do not include MIDI files in the analysis report");
+	options.define("mmap=b", "Memory map the input file instead of reading it");
+	options.define("stdin=b", "Read the image from standard input");
+	options.define("duplicates=s", "Check for duplicate frames: mark or drop");
+	options.define("sweep=s", "List hole counts for thresholds in a range (min:max)");
+	options.define("segments=b", "Stitch all pages of the input files into one image");
+	options.define("rows=s", "Only analyze a range of image rows (start:end; implies -n unless start is 0)");
+	options.define("feet=d:0.0", "Only analyze the first given feet of the image");
+	options.define("leader-only=b", "Only analyze the start of the image with the leader");
+	options.define("dust-sample=i:1", "Count margin dust in every nth row only");
+	options.define("lean=b", "Free the grayscale image after thresholding to save memory");
+	options.define("straighten=s", "Write the drift-corrected image to the given filename");
+	options.define("subpixel=b", "Interpolate the straightened image between pixels");
 	options.process(argc, argv);
 
-	if (options.getArgCount() != 1) {
-		cerr << "Usage: tiff2holes [-rgl58tmse] file.tiff > analysis.txt" << endl;
+	bool stdinQ = options.getBoolean("stdin");
+	bool segmentsQ = options.getBoolean("segments") || (options.getArgCount() > 1);
+	if ((stdinQ && (options.getArgCount() != 0)) ||
+			(!stdinQ && (options.getArgCount() < 1)) ||
+			(!stdinQ && !segmentsQ && (options.getArgCount() != 1))) {
+		cerr << "Usage: tiff2holes [-rgl58tmse] file.tiff [segment2.tiff ...] > analysis.txt" << endl;
 		cerr << "file.tiff must be a 24-bit color image, uncompressed" << endl;
 		cerr << "unless -m is supplied; then file.tiff must be a monochrome" << endl;
 		cerr << "(8-bit, single-channel) image, uncompressed" << endl;
@@ -59,27 +113,43 @@ int main(int argc, char** argv) {
 	}
 
 	RollImage roll;
-	if (!roll.open(options.getArg(1))) {
-		cerr << "Input filename " << options.getArg(1) << " cannot be opened" << endl;
+	string filename = stdinQ ? "stdin" : options.getArg(1);
+	bool status;
+	if (segmentsQ && !stdinQ) {
+		vector<string> filenames;
+		for (int i=1; i<=options.getArgCount(); i++) {
+			filenames.push_back(options.getArg(i));
+		}
+		status = roll.openSegments(filenames);
+	} else if (stdinQ) {
+		status = roll.openStream(cin, filename);
+	} else if (options.getBoolean("mmap")) {
+		status = roll.openMapped(filename);
+	} else {
+		status = roll.open(filename);
+	}
+	if (!status) {
+		cerr << "Input filename " << filename << " cannot be opened" << endl;
 		exit(1);
 	}
 
+	string rolltype;
 	if (options.getBoolean("red-welte")) {
-		roll.setRollTypeRedWelte();
+		rolltype = "welte-red";
 	} else if (options.getBoolean("green-welte")) {
-		roll.setRollTypeGreenWelte();
+		rolltype = "welte-green";
 	} else if (options.getBoolean("licensee-welte")) {
-		roll.setRollTypeLicenseeWelte();
+		rolltype = "welte-licensee";
 	} else if (options.getBoolean("65-note")) {
-		roll.setRollType65Note();
+		rolltype = "65-note";
 	} else if (options.getBoolean("88-note")) {
-		roll.setRollType88Note();
+		rolltype = "88-note";
 	} else if (options.getBoolean("ampico")) {
-		roll.setRollTypeAmpico();
+		rolltype = "ampico";
 	} else if (options.getBoolean("ampico-b")) {
-		roll.setRollTypeAmpicoB();
+		rolltype = "ampico_b";
 	} else if (options.getBoolean("duo-art")) {
-		roll.setRollTypeDuoArt();
+		rolltype = "duo-art";
 	} else {
 		cerr << "A Roll type is required:" << endl;
 		cerr << "   -r   == for red Welte rolls"   << endl;
@@ -105,6 +175,49 @@ int main(int argc, char** argv) {
 		roll.setMissingLeaders(true);
 	}
 
+	if (options.getBoolean("mirror")) {
+		roll.setColumnMirror(true);
+	}
+
+	roll.setThreshold16(options.getInteger("threshold16"));
+	roll.setAutoThreshold(options.getBoolean("auto-threshold"));
+
+	if (options.getBoolean("duplicates")) {
+		string mode = options.getString("duplicates");
+		if (mode == "mark") {
+			roll.setDuplicateFrames(DUPLICATES_MARK);
+		} else if (mode == "drop") {
+			roll.setDuplicateFrames(DUPLICATES_DROP);
+		} else {
+			cerr << "Duplicate frame handling must be \"mark\" or \"drop\"" << endl;
+			exit(1);
+		}
+	}
+
+	if (options.getBoolean("rows")) {
+		ulongint startrow = 0;
+		ulongint endrow = 0;
+		if ((sscanf(options.getString("rows").c_str(), "%lu:%lu", &startrow, &endrow) != 2) ||
+				(endrow < startrow)) {
+			cerr << "Row range must be given as start:end" << endl;
+			exit(1);
+		}
+		roll.setRowRange(startrow, endrow + 1);
+	} else if (options.getDouble("feet") > 0.0) {
+		double rows = options.getDouble("feet") * 12.0 * roll.getPixelsPerInch();
+		roll.setRowRange(0, (ulongint)rows);
+	}
+	roll.setLeaderOnly(options.getBoolean("leader-only"));
+	roll.setDustSampling(options.getInteger("dust-sample"));
+
+	if (options.getBoolean("lean")) {
+		if (options.getBoolean("sweep")) {
+			cerr << "A threshold sweep needs the grayscale image, so it cannot be used with --lean" << endl;
+			exit(1);
+		}
+		roll.setLeanMemory(true);
+	}
+
 	int threshold = options.getInteger("threshold");
 
 	int trackerShift = options.getInteger("alignment-shift");
@@ -112,11 +225,65 @@ int main(int argc, char** argv) {
 	roll.setDebugOn();
 	roll.setWarningOn();
 	roll.setMonochrome(options.getBoolean("monochrome"));
-	roll.loadGreenChannel(threshold);
 	roll.setAlignmentShift(trackerShift);
-	roll.analyze();
+	if (roll.analyzeRoll(rolltype, threshold) != ROLL_OK) {
+		cerr << roll.getStatusMessage() << endl;
+		exit(1);
+	}
+	if (options.getBoolean("no-embedded-midi")) {
+		roll.setEmbeddedMidiFiles(false);
+	}
+	if (options.getBoolean("sweep")) {
+		int minthreshold = 0;
+		int maxthreshold = 0;
+		if (sscanf(options.getString("sweep").c_str(), "%d:%d", &minthreshold, &maxthreshold) != 2) {
+			cerr << "Threshold sweep must be given as min:max" << endl;
+			exit(1);
+		}
+		if (!roll.analyzeThresholdSweep(minthreshold, maxthreshold)) {
+			exit(1);
+		}
+	}
 	roll.printRollImageProperties();
 
+	if (options.getBoolean("straighten")) {
+		if (!roll.writeStraightenedImage(options.getString("straighten"),
+				options.getBoolean("subpixel"))) {
+			exit(1);
+		}
+	}
+
+	if (options.getBoolean("note-midi")) {
+		writeMidiFile(roll, options.getString("note-midi"), false);
+	}
+	if (options.getBoolean("hole-midi")) {
+		writeMidiFile(roll, options.getString("hole-midi"), true);
+	}
+
 	return 0;
 }
 
+
+
+//////////////////////////////
+//
+// writeMidiFile -- Write the note or hole MIDI file for the roll as a
+//     binary Standard MIDI File.
+//
+
+void writeMidiFile(RollImage& roll, const string& filename, bool holeQ) {
+	fstream output;
+	output.open(filename.c_str(), ios::binary | ios::out);
+	if (!output.is_open()) {
+		cerr << "Output filename " << filename << " cannot be opened" << endl;
+		exit(1);
+	}
+	if (holeQ) {
+		roll.writeHoleMidiFile(output);
+	} else {
+		roll.writeNoteMidiFile(output);
+	}
+	output.close();
+}
+
+